@@ -0,0 +1,990 @@
+// Headless benchmarks for the world simulation.
+//
+// Usage: sand_bench [lookup|memory|region|palette|render|simloop|offscreen|enemies|raycast]
+//        sand_bench <scenario|all|determinism> [--ticks N] [--seed N] [--scene file.png|file.lvl]
+//   lookup  - chunk lookups/sec: hash map vs flat chunk table vs tile neighbourhood cache
+//   memory  - cell storage resident for the chunks loaded around the camera
+//   region  - region store round trip (exit code 1 on mismatch) and save/load time per chunk
+//   palette - scene colour lookup table vs exact search over every RGB colour (exit code 1 on mismatch)
+//   render  - viewport rasterisation: full 4K redraw vs the original clear + copy, and
+//             incremental redraw during a simulation vs full redraws (exit code 1 on mismatch)
+//   simloop - fixed-timestep simulation thread under a 100 FPS frame loop: steps/sec, skipped
+//             steps, snapshots/sec and how long frames wait for the world lock
+//   offscreen - water beside the view with the reduced-rate off-screen update off and on
+//             (exit code 1 unless it only falls with the update on)
+//   enemies - bullet hit tests and homing queries: loop over every enemy vs the enemy grid
+//             (exit code 1 on mismatch)
+//   raycast - bullet paths through thin walls: World::raycast vs sampling every 2 pixels with
+//             isOccupied (exit code 1 if a raycast misses a cell or reports an empty one)
+//
+// Scenarios (avalanche, flood, lava, explosions, freefall) build a scripted setup around the
+// camera and run World::update for a fixed number of ticks from a fixed seed. Each prints one
+// JSON line: ticks/sec, particles updated/sec, particle chunks processed, off-screen tiles
+// updated, heat tiles swept and phase changes, the largest wetness frontier and time spent on
+// it, the most particles in flight at once and how many landed or were lost, p50/p99 tick
+// time and a state checksum (equal checksums = identical runs).
+// Off-screen updates run without a time budget here, so runs stay reproducible.
+//   determinism - every scenario with 1 OpenMP thread and with several (exit code 1 if any
+//             checksum differs between the two)
+
+#include "World.h"
+#include "EnemyGrid.h"
+#include "RegionStore.h"
+#include "ScenePalette.h"
+#include "SimulationLoop.h"
+#include "ViewportRenderer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <omp.h>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// World position used by every benchmark (inside the world, away from the edges)
+constexpr int BENCH_CENTER_X = 20 * WorldChunk::CHUNK_SIZE + 256;
+constexpr int BENCH_CENTER_Y = 20 * WorldChunk::CHUNK_SIZE + 256;
+
+void setupWorld(World& world) {
+    world.setViewportSize(533, 300);
+    world.getCamera().centerOn(BENCH_CENTER_X, BENCH_CENTER_Y, World::WORLD_WIDTH, World::WORLD_HEIGHT);
+    world.loadChunksAroundCamera();
+}
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Random cells inside one simulation tile's reach, the access pattern of the cell loop
+std::vector<int> makeLookupCoords(int count) {
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<int> offset(-World::SIM_TILE_SIZE / 2, World::SIM_TILE_SIZE + World::SIM_TILE_SIZE / 2);
+
+    // A tile that straddles a chunk corner, so lookups hit several chunks
+    int tileX = BENCH_CENTER_X + WorldChunk::CHUNK_SIZE / 2 - World::SIM_TILE_SIZE / 2;
+    int tileY = BENCH_CENTER_Y + WorldChunk::CHUNK_SIZE / 2 - World::SIM_TILE_SIZE / 2;
+
+    std::vector<int> coords(count * 2);
+    for (int i = 0; i < count; ++i) {
+        coords[i * 2] = tileX + offset(rng);
+        coords[i * 2 + 1] = tileY + offset(rng);
+    }
+    return coords;
+}
+
+void runLookupBenchmark() {
+    Config config;
+    World world(config);
+    setupWorld(world);
+
+    const int lookups = 20000000;
+    std::vector<int> coords = makeLookupCoords(lookups);
+    const auto& chunkMap = world.getChunks();
+
+    auto report = [&](const char* name, double seconds, std::uintptr_t checksum) {
+        std::cout << "  " << name << ": " << (lookups / seconds / 1e6) << " M lookups/s"
+                  << " (" << seconds * 1000.0 << " ms, checksum " << (checksum & 0xffff) << ")" << std::endl;
+    };
+
+    std::cout << "Chunk lookup (" << lookups << " lookups, " << chunkMap.size() << " chunks loaded)" << std::endl;
+
+    // Old path: world -> chunk coordinates -> unordered_map::find
+    auto start = Clock::now();
+    std::uintptr_t checksum = 0;
+    for (int i = 0; i < lookups; ++i) {
+        int chunkX, chunkY;
+        World::worldToChunk(coords[i * 2], coords[i * 2 + 1], chunkX, chunkY);
+        auto it = chunkMap.find(ChunkKey{chunkX, chunkY});
+        checksum += reinterpret_cast<std::uintptr_t>(it != chunkMap.end() ? it->second.get() : nullptr);
+    }
+    report("unordered_map", secondsSince(start), checksum);
+
+    // Flat chunk table
+    start = Clock::now();
+    checksum = 0;
+    for (int i = 0; i < lookups; ++i) {
+        checksum += reinterpret_cast<std::uintptr_t>(world.findChunkAtWorldPos(coords[i * 2], coords[i * 2 + 1]));
+    }
+    report("chunk table  ", secondsSince(start), checksum);
+
+    // 3x3 neighbourhood resolved once for the tile
+    ChunkNeighborhood neighborhood;
+    int originX, originY;
+    World::worldToChunk(BENCH_CENTER_X, BENCH_CENTER_Y, originX, originY);
+    world.getChunkNeighborhood(originX, originY, neighborhood);
+
+    start = Clock::now();
+    checksum = 0;
+    for (int i = 0; i < lookups; ++i) {
+        checksum += reinterpret_cast<std::uintptr_t>(neighborhood.at(coords[i * 2], coords[i * 2 + 1]));
+    }
+    report("neighborhood ", secondsSince(start), checksum);
+}
+
+void runMemoryBenchmark() {
+    Config config;
+    World world(config);
+    setupWorld(world);
+
+    size_t totalBytes = 0;
+    size_t largestChunk = 0;
+    for (const auto& [key, chunk] : world.getChunks()) {
+        size_t bytes = chunk->getMemoryUsage();
+        totalBytes += bytes;
+        largestChunk = std::max(largestChunk, bytes);
+    }
+
+    size_t chunkCount = world.getChunks().size();
+    std::cout << "Cell storage (" << chunkCount << " chunks loaded)" << std::endl;
+    std::cout << "  total:         " << totalBytes / (1024.0 * 1024.0) << " MB" << std::endl;
+    std::cout << "  per chunk avg: " << totalBytes / (1024.0 * 1024.0) / std::max<size_t>(1, chunkCount) << " MB" << std::endl;
+    std::cout << "  largest chunk: " << largestChunk / (1024.0 * 1024.0) << " MB" << std::endl;
+}
+
+// Terrain-like chunk: rock below a wavy surface, sand and water pockets, a warm patch
+std::unique_ptr<WorldChunk> makeTestChunk(int chunkX, int chunkY, std::mt19937& rng) {
+    auto chunk = std::make_unique<WorldChunk>(chunkX, chunkY);
+    std::uniform_int_distribution<int> shade(0, 40);
+
+    for (int y = 0; y < WorldChunk::CHUNK_SIZE; ++y) {
+        for (int x = 0; x < WorldChunk::CHUNK_SIZE; ++x) {
+            int surface = 200 + (int)(40.0 * std::sin((x + chunkX * 97) * 0.02));
+            if (y < surface) continue;
+
+            ParticleType type = ParticleType::ROCK;
+            if (y < surface + 30) type = ParticleType::SAND;
+            if ((x / 64 + y / 64) % 7 == 0) type = ParticleType::WATER;
+
+            chunk->setParticle(x, y, type);
+            chunk->setColor(x, y, {(unsigned char)(100 + shade(rng)), (unsigned char)(90 + shade(rng)), (unsigned char)(80 + shade(rng))});
+            chunk->setSettled(x, y, type == ParticleType::ROCK);
+        }
+    }
+
+    for (int y = 300; y < 320; ++y) {
+        for (int x = 100; x < 140; ++x) {
+            chunk->setTemperature(x, y, 400.0f);
+        }
+    }
+    return chunk;
+}
+
+int runRegionBenchmark() {
+    const int chunkCount = 16;
+    const std::string dir = (std::filesystem::temp_directory_path() / "sand_bench_regions").string();
+
+    std::mt19937 rng(12345);
+    std::vector<std::vector<unsigned char>> expected(chunkCount);
+    std::vector<std::unique_ptr<WorldChunk>> originals;
+    for (int i = 0; i < chunkCount; ++i) {
+        // Spread over two region files
+        originals.push_back(makeTestChunk(4 + i, 10, rng));
+        originals.back()->serialize(expected[i]);
+    }
+
+    bool ok = true;
+    size_t serializedBytes = 0;
+    size_t residentBytes = 0;
+    for (int i = 0; i < chunkCount; ++i) {
+        serializedBytes += expected[i].size();
+        residentBytes += originals[i]->getMemoryUsage();
+    }
+
+    RegionStore store(dir);
+    if (!store.isOpen()) {
+        std::cerr << "Could not open region store in " << dir << std::endl;
+        return 1;
+    }
+
+    // Queue and immediately take back: served from the pending queue, no disk access
+    store.save(makeTestChunk(40, 40, rng));
+    ok &= store.load(40, 40) != nullptr;
+
+    auto start = Clock::now();
+    for (auto& chunk : originals) {
+        store.save(std::move(chunk));
+    }
+    store.flush();
+    double flushSeconds = secondsSince(start);
+
+    for (int i = 0; i < chunkCount; ++i) {
+        auto restored = store.load(4 + i, 10);
+        std::vector<unsigned char> bytes;
+        if (restored) restored->serialize(bytes);
+        if (bytes != expected[i]) {
+            std::cerr << "Round trip mismatch for chunk " << i << std::endl;
+            ok = false;
+        }
+    }
+    ok &= !store.contains(4, 10);  // Loading hands the chunk back to the world
+
+    RegionStore::Stats stats = store.getStats();
+    std::cout << "Region store (" << chunkCount << " chunks, " << RegionStore::REGION_SIZE << "x"
+              << RegionStore::REGION_SIZE << " chunks per region file)" << std::endl;
+    std::cout << "  record size:   " << serializedBytes / chunkCount / 1024.0 << " KB/chunk (resident "
+              << residentBytes / chunkCount / 1024.0 << " KB)" << std::endl;
+    std::cout << "  save:          " << stats.writeSeconds * 1000.0 / std::max(1, stats.chunksWritten) << " ms/chunk"
+              << " (queue drained in " << flushSeconds * 1000.0 << " ms)" << std::endl;
+    std::cout << "  load:          " << stats.readSeconds * 1000.0 / std::max(1, stats.chunksRead) << " ms/chunk" << std::endl;
+    std::cout << "  reclaimed:     " << stats.chunksReclaimed << " chunk(s) from the write queue" << std::endl;
+    std::cout << "  round trip:    " << (ok ? "OK" : "FAILED") << std::endl;
+
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+    return ok ? 0 : 1;
+}
+
+int runPaletteBenchmark() {
+    // Rules used by chunk population and by loadSceneFromBMP
+    const int rules[][2] = {{30, 3500}, {10, 5000}};
+    bool ok = true;
+
+    for (const auto& rule : rules) {
+        ScenePalette palette(rule[0], rule[1]);
+
+        auto start = Clock::now();
+        unsigned checksum = 0;
+        for (int c = 0; c < (1 << 24); ++c) {
+            checksum += palette.classifyExact(c >> 16, (c >> 8) & 0xff, c & 0xff);
+        }
+        double exactSeconds = secondsSince(start);
+
+        start = Clock::now();
+        unsigned tableChecksum = 0;
+        for (int c = 0; c < (1 << 24); ++c) {
+            tableChecksum += palette.classify(c >> 16, (c >> 8) & 0xff, c & 0xff);
+        }
+        double tableSeconds = secondsSince(start);
+
+        // Checksums catch most differences cheaply; compare every colour to be sure
+        int mismatches = 0;
+        for (int c = 0; c < (1 << 24); ++c) {
+            int r = c >> 16, g = (c >> 8) & 0xff, b = c & 0xff;
+            if (palette.classify(r, g, b) != palette.classifyExact(r, g, b)) mismatches++;
+        }
+        ok &= mismatches == 0 && checksum == tableChecksum;
+
+        std::cout << "Scene palette (dark cutoff " << rule[0] << ", threshold " << rule[1] << ")" << std::endl;
+        std::cout << "  ambiguous:     " << palette.getAmbiguousFraction() * 100.0f << "% of buckets" << std::endl;
+        std::cout << "  exact search:  " << (1 << 24) / exactSeconds / 1e6 << " M pixels/s" << std::endl;
+        std::cout << "  lookup table:  " << (1 << 24) / tableSeconds / 1e6 << " M pixels/s" << std::endl;
+        std::cout << "  mismatches:    " << mismatches << std::endl;
+    }
+
+    std::cout << "  all colours:   " << (ok ? "OK" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
+
+// Scenarios
+
+struct ScenarioOptions {
+    int ticks = 600;
+    unsigned seed = 1;
+    std::string scene;  // Optional scene image or baked level
+};
+
+// World position the camera is centred on; inside level1's terrain when a scene is loaded
+void scenarioCenter(const ScenarioOptions& options, int& x, int& y) {
+    x = options.scene.empty() ? BENCH_CENTER_X : 3000;
+    y = options.scene.empty() ? BENCH_CENTER_Y : 34000;
+}
+
+void fillRect(World& world, int x, int y, int w, int h, ParticleType type) {
+    for (int py = y; py < y + h; ++py) {
+        for (int px = x; px < x + w; ++px) {
+            world.spawnParticleAt(px, py, type);
+        }
+    }
+}
+
+// Rock floor and side walls around the viewport
+void buildBasin(World& world, int left, int top, int width, int height) {
+    fillRect(world, left, top + height - 12, width, 12, ParticleType::ROCK);
+    fillRect(world, left, top, 8, height, ParticleType::ROCK);
+    fillRect(world, left + width - 8, top, 8, height, ParticleType::ROCK);
+}
+
+// Sand block dropped onto a rock ramp
+void setupAvalanche(World& world, int left, int top, int width, int height) {
+    buildBasin(world, left, top, width, height);
+    for (int i = 0; i < 260; ++i) {
+        int rampHeight = (260 - i) * 2 / 3;
+        fillRect(world, left + 8 + i, top + height - 12 - rampHeight, 1, rampHeight, ParticleType::ROCK);
+    }
+    fillRect(world, left + 30, top + 5, 200, 90, ParticleType::SAND);
+}
+
+// Water column released across a floor with pillars
+void setupFlood(World& world, int left, int top, int width, int height) {
+    buildBasin(world, left, top, width, height);
+    for (int x = left + 220; x < left + width - 40; x += 70) {
+        fillRect(world, x, top + height - 80, 12, 68, ParticleType::ROCK);
+    }
+    fillRect(world, left + 8, top + 20, 160, height - 32, ParticleType::WATER);
+}
+
+// Lava poured into a water pool
+void setupLava(World& world, int left, int top, int width, int height) {
+    buildBasin(world, left, top, width, height);
+    fillRect(world, left + 8, top + height - 72, width - 16, 60, ParticleType::WATER);
+    fillRect(world, left + width / 2 - 50, top + 10, 100, 90, ParticleType::LAVA);
+}
+
+// Wide slabs of sand and water falling through open air onto the floor
+void setupFreefall(World& world, int left, int top, int width, int height) {
+    buildBasin(world, left, top, width, height);
+    fillRect(world, left + 8, top + 5, width / 2 - 8, 60, ParticleType::SAND);
+    fillRect(world, left + width / 2, top + 5, width / 2 - 8, 60, ParticleType::WATER);
+}
+
+// Layered terrain; explosions are scripted while the scenario runs
+void setupExplosions(World& world, int left, int top, int width, int height) {
+    buildBasin(world, left, top, width, height);
+    fillRect(world, left + 8, top + height - 72, width - 16, 60, ParticleType::ROCK);
+    fillRect(world, left + 8, top + height - 152, width - 16, 80, ParticleType::SAND);
+    for (int x = left + 40; x < left + width - 60; x += 120) {
+        fillRect(world, x, top + height - 140, 40, 30, ParticleType::WATER);
+    }
+}
+
+int runRenderBenchmark() {
+    Config config;
+    config.chunkGenerationThreads = 0;
+    config.persistDistantChunks = false;
+    config.worldSeed = 1;
+    std::ostringstream setupLog;
+    std::streambuf* stdoutBuffer = std::cout.rdbuf(setupLog.rdbuf());
+    World world(config);
+    std::cout.rdbuf(stdoutBuffer);
+    bool ok = true;
+
+    // Full rasterisation at 4K over half-filled terrain, every chunk under it loaded
+    {
+        constexpr int WIDTH = 3840, HEIGHT = 2160;
+        constexpr int FRAMES = 30;
+        int left = BENCH_CENTER_X - WIDTH / 2, top = BENCH_CENTER_Y - HEIGHT / 2;
+        std::mt19937 rng(1);
+        for (int y = top; y < top + HEIGHT; ++y) {
+            for (int x = left; x < left + WIDTH; ++x) {
+                world.getChunk(x / WorldChunk::CHUNK_SIZE, y / WorldChunk::CHUNK_SIZE);
+                unsigned roll = rng() % 100;
+                if (roll < 50) continue;
+                world.setParticle(x, y, roll < 80 ? ParticleType::ROCK : ParticleType::SAND);
+                world.setColor(x, y, {(unsigned char)rng(), (unsigned char)rng(), (unsigned char)rng()});
+            }
+        }
+
+        // Reference: the original clear followed by a per-chunk copy of non-empty cells
+        std::vector<uint32_t> reference(WIDTH * HEIGHT);
+        auto start = Clock::now();
+        for (int frame = 0; frame < FRAMES; ++frame) {
+            std::fill(reference.begin(), reference.end(), 0u);
+            for (int cy = top / WorldChunk::CHUNK_SIZE; cy <= (top + HEIGHT - 1) / WorldChunk::CHUNK_SIZE; ++cy) {
+                for (int cx = left / WorldChunk::CHUNK_SIZE; cx <= (left + WIDTH - 1) / WorldChunk::CHUNK_SIZE; ++cx) {
+                    const WorldChunk* chunk = world.findChunk(cx, cy);
+                    const auto& particles = chunk->getParticleGrid();
+                    const auto& colors = chunk->getColorGrid();
+                    int xStart = std::max(left, chunk->getWorldX()), xEnd = std::min(left + WIDTH, chunk->getWorldX() + WorldChunk::CHUNK_SIZE);
+                    int yStart = std::max(top, chunk->getWorldY()), yEnd = std::min(top + HEIGHT, chunk->getWorldY() + WorldChunk::CHUNK_SIZE);
+
+                    for (int y = yStart; y < yEnd; ++y) {
+                        for (int x = xStart; x < xEnd; ++x) {
+                            int idx = (y - chunk->getWorldY()) * WorldChunk::CHUNK_SIZE + (x - chunk->getWorldX());
+                            if (particles[idx] != ParticleType::EMPTY) {
+                                const ParticleColor& color = colors[idx];
+                                reference[(y - top) * WIDTH + (x - left)] = 0xFF000000 | (color.r << 16) | (color.g << 8) | color.b;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        double referenceSeconds = secondsSince(start);
+
+        ViewportRenderer renderer(WIDTH, HEIGHT);
+        start = Clock::now();
+        for (int frame = 0; frame < FRAMES; ++frame) {
+            renderer.invalidate();
+            renderer.render(world, left, top);
+            renderer.finishFrame();
+        }
+        double fullSeconds = secondsSince(start);
+        bool same = renderer.getPixels() == reference;
+        ok &= same;
+
+        start = Clock::now();
+        for (int frame = 0; frame < FRAMES; ++frame) {
+            renderer.render(world, left, top);
+            renderer.finishFrame();
+        }
+        double staticSeconds = secondsSince(start);
+
+        std::cout << "Viewport rasterisation (" << WIDTH << "x" << HEIGHT << ")" << std::endl;
+        std::cout << "  clear + copy:       " << referenceSeconds * 1000.0 / FRAMES << " ms/frame" << std::endl;
+        std::cout << "  full redraw:        " << fullSeconds * 1000.0 / FRAMES << " ms/frame" << std::endl;
+        std::cout << "  unchanged frame:    " << staticSeconds * 1000.0 / FRAMES << " ms/frame, "
+                  << renderer.getRasterisedPixels() << " pixels redrawn, " << renderer.getUploadedPixels() << " uploaded" << std::endl;
+        std::cout << "  pixels:             " << (same ? "OK" : "FAILED") << std::endl;
+    }
+
+    // Incremental redraw while lava, water and fire are simulated and the camera pans now
+    // and then: every frame must match a full redraw
+    {
+        constexpr int WIDTH = 533, HEIGHT = 300;
+        constexpr int TICKS = 300;
+        world.setViewportSize(WIDTH, HEIGHT);
+        world.getCamera().centerOn(BENCH_CENTER_X + 4 * WorldChunk::CHUNK_SIZE, BENCH_CENTER_Y, World::WORLD_WIDTH, World::WORLD_HEIGHT);
+        world.loadChunksAroundCamera();
+        int left = (int)world.getCamera().x, top = (int)world.getCamera().y;
+
+        stdoutBuffer = std::cout.rdbuf(setupLog.rdbuf());
+        setupLava(world, left, top, WIDTH, HEIGHT);
+        fillRect(world, left + 60, top + HEIGHT - 40, 120, 8, ParticleType::FIRE);
+        std::cout.rdbuf(stdoutBuffer);
+
+        ViewportRenderer incremental(WIDTH, HEIGHT);
+        ViewportRenderer full(WIDTH, HEIGHT);
+        std::mt19937 rng(2);
+        long long rasterised = 0, uploaded = 0;
+        int mismatchedFrames = 0;
+
+        for (int tick = 0; tick < TICKS; ++tick) {
+            world.update(1.0f / 60.0f);
+            int cameraX = left + (tick / 10) % 7 - 3;  // Pans a cell every 10 ticks
+            int cameraY = top + (tick / 25) % 3 - 1;
+
+            incremental.render(world, cameraX, cameraY);
+            full.invalidate();
+            full.render(world, cameraX, cameraY);
+            if (incremental.getPixels() != full.getPixels()) mismatchedFrames++;
+
+            // A bullet-like overlay, restored by the next frame
+            incremental.getPixels()[rng() % (WIDTH * HEIGHT)] = 0xFFFFFFFF;
+            incremental.finishFrame();
+            full.finishFrame();
+            rasterised += incremental.getRasterisedPixels();
+            uploaded += incremental.getUploadedPixels();
+        }
+        ok &= mismatchedFrames == 0;
+
+        double framePixels = (double)WIDTH * HEIGHT * TICKS;
+        std::cout << "Incremental redraw (" << WIDTH << "x" << HEIGHT << ", " << TICKS << " simulated frames)" << std::endl;
+        std::cout << "  redrawn:            " << rasterised * 100.0 / framePixels << "% of pixels" << std::endl;
+        std::cout << "  uploaded:           " << uploaded * 100.0 / framePixels << "% of pixels" << std::endl;
+        std::cout << "  mismatched frames:  " << mismatchedFrames << std::endl;
+    }
+
+    return ok ? 0 : 1;
+}
+
+// Order-sensitive hash of every cell type in the simulated region
+uint64_t stateChecksum(const World& world, int left, int top, int width, int height) {
+    uint64_t hash = 1469598103934665603ull;
+    for (int y = top - World::SIM_TILE_SIZE; y < top + height + World::SIM_TILE_SIZE; ++y) {
+        for (int x = left - World::SIM_TILE_SIZE; x < left + width + World::SIM_TILE_SIZE; ++x) {
+            hash = (hash ^ (uint64_t)world.getParticle(x, y)) * 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+double percentile(std::vector<double> values, double fraction) {
+    if (values.empty()) return 0.0;
+    size_t index = std::min(values.size() - 1, (size_t)(fraction * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+// Prints the scenario's JSON line; the final state checksum is also stored in *checksum if given
+bool runScenario(const std::string& name, const ScenarioOptions& options, uint64_t* checksum = nullptr) {
+    using Setup = void (*)(World&, int, int, int, int);
+    Setup setup = nullptr;
+    if (name == "avalanche") setup = setupAvalanche;
+    else if (name == "flood") setup = setupFlood;
+    else if (name == "lava") setup = setupLava;
+    else if (name == "explosions") setup = setupExplosions;
+    else if (name == "freefall") setup = setupFreefall;
+    if (!setup) return false;
+
+    // Fixed inputs: no background generation, no disk cache
+    Config config;
+    config.chunkGenerationThreads = 0;
+    config.persistDistantChunks = false;
+    config.worldSeed = options.seed;
+    config.offscreenSimulationBudgetMs = 0.0f;  // A time budget would make runs machine-dependent
+
+    // World progress messages would break the JSON output
+    std::ostringstream setupLog;
+    std::streambuf* stdoutBuffer = std::cout.rdbuf(setupLog.rdbuf());
+
+    World world(config);
+    if (!options.scene.empty()) {
+        bool level = options.scene.size() > 4 && options.scene.compare(options.scene.size() - 4, 4, ".lvl") == 0;
+        bool loaded = level ? world.setSceneLevel(options.scene) : world.setSceneImage(options.scene);
+        if (!loaded) {
+            std::cout.rdbuf(stdoutBuffer);
+            return false;
+        }
+    }
+
+    int centerX, centerY;
+    scenarioCenter(options, centerX, centerY);
+    world.setViewportSize(533, 300);
+    world.getCamera().centerOn(centerX, centerY, World::WORLD_WIDTH, World::WORLD_HEIGHT);
+    world.loadChunksAroundCamera();
+
+    const Camera& camera = world.getCamera();
+    int left = (int)camera.x, top = (int)camera.y;
+    setup(world, left, top, camera.viewportWidth, camera.viewportHeight);
+    std::cout.rdbuf(stdoutBuffer);
+
+    std::mt19937 rng(options.seed);
+    std::vector<double> tickMs;
+    tickMs.reserve(options.ticks);
+    long long particlesUpdated = 0;
+    long long chunksProcessed = 0;
+    long long offscreenTiles = 0;
+    long long heatTiles = 0;
+    long long phaseChanges = 0;
+    double heatMs = 0.0;
+    int wetFrontierMax = 0;
+    double wetnessMs = 0.0;
+    int ballisticMax = 0;
+    long long ballisticLanded = 0;
+    long long ballisticLost = 0;
+
+    auto start = Clock::now();
+    for (int tick = 0; tick < options.ticks; ++tick) {
+        auto tickStart = Clock::now();
+        if (name == "explosions" && tick % 20 == 0) {
+            std::uniform_int_distribution<int> blastX(left + 40, left + camera.viewportWidth - 40);
+            std::uniform_int_distribution<int> blastY(top + camera.viewportHeight - 150, top + camera.viewportHeight - 60);
+            world.explodeAt(blastX(rng), blastY(rng), 24, 200.0f);
+        }
+        world.update(1.0f / 60.0f);
+        tickMs.push_back(secondsSince(tickStart) * 1000.0);
+
+        const WorldUpdateStats& stats = world.getLastUpdateStats();
+        particlesUpdated += stats.particlesUpdated;
+        chunksProcessed += stats.particleChunksProcessed;
+        offscreenTiles += stats.offscreenTiles;
+        heatTiles += stats.heatTiles;
+        phaseChanges += stats.phaseChanges;
+        heatMs += stats.heatMicros / 1000.0;
+        wetFrontierMax = std::max(wetFrontierMax, stats.wetCells);
+        wetnessMs += stats.wetnessMicros / 1000.0;
+        ballisticMax = std::max(ballisticMax, stats.ballisticParticles);
+        ballisticLanded += stats.ballisticLanded;
+        ballisticLost += stats.ballisticLost;
+    }
+    double seconds = secondsSince(start);
+    uint64_t finalChecksum = stateChecksum(world, left, top, camera.viewportWidth, camera.viewportHeight);
+    if (checksum) *checksum = finalChecksum;
+
+    std::cout << "{\"scenario\":\"" << name << "\""
+              << ",\"ticks\":" << options.ticks
+              << ",\"seed\":" << options.seed
+              << ",\"scene\":\"" << options.scene << "\""
+              << ",\"ticks_per_sec\":" << options.ticks / seconds
+              << ",\"particles_updated_per_sec\":" << particlesUpdated / seconds
+              << ",\"particles_updated\":" << particlesUpdated
+              << ",\"particle_chunks_processed\":" << chunksProcessed
+              << ",\"offscreen_tiles\":" << offscreenTiles
+              << ",\"heat_tiles\":" << heatTiles
+              << ",\"heat_ms\":" << heatMs
+              << ",\"phase_changes\":" << phaseChanges
+              << ",\"wet_frontier_max\":" << wetFrontierMax
+              << ",\"wetness_ms\":" << wetnessMs
+              << ",\"ballistic_max\":" << ballisticMax
+              << ",\"ballistic_landed\":" << ballisticLanded
+              << ",\"ballistic_lost\":" << ballisticLost
+              << ",\"tick_ms_p50\":" << percentile(tickMs, 0.50)
+              << ",\"tick_ms_p99\":" << percentile(tickMs, 0.99)
+              << ",\"tick_ms_max\":" << *std::max_element(tickMs.begin(), tickMs.end())
+              << ",\"checksum\":\"" << std::hex << finalChecksum << std::dec << "\""
+              << "}" << std::endl;
+    return true;
+}
+
+// Each scenario once with a single OpenMP thread and once with several. The tiles of a phase
+// run in whatever order the threads pick them up, so this catches randomness or shared state
+// that depends on scheduling. Exit code 1 if any checksum differs.
+int runDeterminismCheck(const ScenarioOptions& options) {
+    const int threads = std::max(4, omp_get_max_threads());
+    bool ok = true;
+    for (const char* name : {"avalanche", "flood", "lava", "explosions", "freefall"}) {
+        uint64_t single = 0, multi = 0;
+        omp_set_num_threads(1);
+        if (!runScenario(name, options, &single)) return 1;
+        omp_set_num_threads(threads);
+        if (!runScenario(name, options, &multi)) return 1;
+
+        std::cout << "{\"mode\":\"determinism\",\"scenario\":\"" << name << "\""
+                  << ",\"threads\":" << threads
+                  << ",\"match\":" << (single == multi ? "true" : "false")
+                  << "}" << std::endl;
+        ok = ok && single == multi;
+    }
+    return ok ? 0 : 1;
+}
+
+// The fixed-timestep simulation thread against a 100 FPS frame loop that pans the camera
+// under the world lock, as main does. Exit code 1 if the simulation did not run or a frame
+// scrolled past the snapshot margin.
+int runSimulationLoopBenchmark() {
+    constexpr int FRAMES = 200;
+    constexpr auto FRAME_TIME = std::chrono::milliseconds(10);
+
+    Config config;
+    config.chunkGenerationThreads = 0;
+    config.persistDistantChunks = false;
+    config.worldSeed = 1;
+    config.simulationStepsPerSecond = 60;
+    std::ostringstream setupLog;
+    std::streambuf* stdoutBuffer = std::cout.rdbuf(setupLog.rdbuf());
+    World world(config);
+    setupWorld(world);
+    Camera& camera = world.getCamera();
+    setupFlood(world, (int)camera.x, (int)camera.y, camera.viewportWidth, camera.viewportHeight);
+    std::cout.rdbuf(stdoutBuffer);
+
+    SimulationLoop simulation(world, camera.viewportWidth, camera.viewportHeight);
+    simulation.start();
+
+    std::vector<double> lockWaitMs;
+    uint64_t lastSequence = 0;
+    int snapshots = 0, outsideMargin = 0;
+    auto start = Clock::now();
+    for (int frame = 0; frame < FRAMES; ++frame) {
+        auto frameStart = Clock::now();
+        {
+            auto lock = simulation.lockWorld();
+            lockWaitMs.push_back(secondsSince(frameStart) * 1000.0);
+            camera.x += (frame / 50) % 2 == 0 ? 2.0f : -2.0f;
+            world.loadChunksAroundCamera();
+        }
+
+        const SimulationLoop::Snapshot& snapshot = simulation.acquireSnapshot();
+        if (snapshot.sequence != lastSequence) snapshots++;
+        lastSequence = snapshot.sequence;
+        int offsetX = (int)camera.x - snapshot.left, offsetY = (int)camera.y - snapshot.top;
+        if (snapshot.sequence && (offsetX < 0 || offsetY < 0 || offsetX > 2 * SimulationLoop::SNAPSHOT_MARGIN || offsetY > 2 * SimulationLoop::SNAPSHOT_MARGIN)) {
+            outsideMargin++;
+        }
+
+        std::this_thread::sleep_until(frameStart + FRAME_TIME);
+    }
+    double seconds = secondsSince(start);
+    simulation.stop();
+
+    std::cout << "{\"mode\":\"simloop\""
+              << ",\"frames\":" << FRAMES
+              << ",\"frames_per_sec\":" << FRAMES / seconds
+              << ",\"steps_per_sec\":" << simulation.getStepsPerSecond()
+              << ",\"skipped_steps\":" << simulation.getSkippedSteps()
+              << ",\"snapshots_per_sec\":" << snapshots / seconds
+              << ",\"lock_wait_ms_p50\":" << percentile(lockWaitMs, 0.50)
+              << ",\"lock_wait_ms_p99\":" << percentile(lockWaitMs, 0.99)
+              << ",\"frames_outside_margin\":" << outsideMargin
+              << "}" << std::endl;
+    return simulation.getStepsPerSecond() > 0 && snapshots > 0 && outsideMargin == 0 ? 0 : 1;
+}
+
+// Water dropped beside the view, inside the loaded area, with the reduced-rate off-screen
+// update off and on. Exit code 1 unless the water stays put with it off and falls with it on.
+int runOffscreenBenchmark() {
+    constexpr int TICKS = 240;
+    constexpr int BLOCK = 60;
+    bool ok = true;
+
+    for (int interval : {0, 3}) {
+        Config config;
+        config.chunkGenerationThreads = 0;
+        config.persistDistantChunks = false;
+        config.worldSeed = 1;
+        config.offscreenSimulationInterval = interval;
+        config.offscreenSimulationBudgetMs = 0.0f;
+        std::ostringstream setupLog;
+        std::streambuf* stdoutBuffer = std::cout.rdbuf(setupLog.rdbuf());
+        World world(config);
+        setupWorld(world);
+        const Camera& camera = world.getCamera();
+        int x = (int)camera.x + camera.viewportWidth + 200;
+        int y = (int)camera.y;
+        fillRect(world, x - 40, y + camera.viewportHeight - 12, BLOCK + 80, 12, ParticleType::ROCK);
+        fillRect(world, x, y, BLOCK, BLOCK, ParticleType::WATER);
+        std::cout.rdbuf(stdoutBuffer);
+
+        std::vector<double> tickMs;
+        long long offscreenTiles = 0;
+        for (int tick = 0; tick < TICKS; ++tick) {
+            auto tickStart = Clock::now();
+            world.update(1.0f / 60.0f);
+            tickMs.push_back(secondsSince(tickStart) * 1000.0);
+            offscreenTiles += world.getLastUpdateStats().offscreenTiles;
+        }
+
+        int waterInPlace = 0;
+        for (int py = y; py < y + BLOCK; ++py) {
+            for (int px = x; px < x + BLOCK; ++px) {
+                if (world.getParticle(px, py) == ParticleType::WATER) waterInPlace++;
+            }
+        }
+        if (interval == 0 && waterInPlace != BLOCK * BLOCK) ok = false;
+        if (interval > 0 && waterInPlace > BLOCK * BLOCK / 2) ok = false;
+
+        std::cout << "{\"mode\":\"offscreen\""
+                  << ",\"interval\":" << interval
+                  << ",\"ticks\":" << TICKS
+                  << ",\"offscreen_tiles\":" << offscreenTiles
+                  << ",\"water_left_in_place\":" << waterInPlace << "/" << BLOCK * BLOCK
+                  << ",\"tick_ms_p50\":" << percentile(tickMs, 0.50)
+                  << ",\"tick_ms_p99\":" << percentile(tickMs, 0.99)
+                  << "}" << std::endl;
+    }
+    return ok ? 0 : 1;
+}
+
+// Enemies scattered over a few screens, bullet path points and homing queries among them.
+// The grid has to find exactly what a loop over the enemy vector finds.
+int runEnemyGridBenchmark() {
+    constexpr int ENEMIES = 2000;
+    constexpr int POINTS = 2000000;
+    constexpr int HOMING_QUERIES = 200000;
+    constexpr float HOMING_RANGE = 150.0f;  // MagicMissile
+    constexpr int AREA_W = 4000, AREA_H = 2000;
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> areaX(BENCH_CENTER_X, BENCH_CENTER_X + AREA_W);
+    std::uniform_real_distribution<float> areaY(BENCH_CENTER_Y, BENCH_CENTER_Y + AREA_H);
+
+    std::vector<LittlePurpleJumper> enemies(ENEMIES);
+    for (int i = 0; i < ENEMIES; ++i) {
+        enemies[i].setPosition(areaX(rng), areaY(rng));
+        if (i % 10 == 0) enemies[i].setActive(false);
+    }
+    std::vector<float> points(POINTS * 2);
+    for (int i = 0; i < POINTS; ++i) {
+        points[i * 2] = areaX(rng);
+        points[i * 2 + 1] = areaY(rng);
+    }
+
+    auto start = Clock::now();
+    EnemyGrid grid;
+    grid.rebuild(enemies);
+    double rebuildSeconds = secondsSince(start);
+
+    // Hit tests: first enemy containing each point, as the index sum
+    start = Clock::now();
+    long long loopHits = 0;
+    for (int i = 0; i < POINTS; ++i) {
+        int x = (int)points[i * 2], y = (int)points[i * 2 + 1];
+        for (int e = 0; e < ENEMIES; ++e) {
+            const LittlePurpleJumper& enemy = enemies[e];
+            if (enemy.isActive() && x >= enemy.getX() && x < enemy.getX() + enemy.getWidth() &&
+                y >= enemy.getY() && y < enemy.getY() + enemy.getHeight()) {
+                loopHits += e + 1;
+                break;
+            }
+        }
+    }
+    double loopHitSeconds = secondsSince(start);
+
+    start = Clock::now();
+    long long gridHits = 0;
+    for (int i = 0; i < POINTS; ++i) {
+        grid.forEachAt((int)points[i * 2], (int)points[i * 2 + 1], [&](LittlePurpleJumper& enemy) {
+            gridHits += &enemy - enemies.data() + 1;
+            return true;
+        });
+    }
+    double gridHitSeconds = secondsSince(start);
+
+    // Homing: nearest centre in range
+    int homingMismatches = 0;
+    double loopHomingSeconds = 0.0, gridHomingSeconds = 0.0;
+    for (int i = 0; i < HOMING_QUERIES; ++i) {
+        float x = points[i * 2], y = points[i * 2 + 1];
+        auto queryStart = Clock::now();
+        const LittlePurpleJumper* nearest = nullptr;
+        float closestDist = HOMING_RANGE;
+        for (const auto& enemy : enemies) {
+            if (!enemy.isActive()) continue;
+            float dx = enemy.getX() + enemy.getWidth() / 2.0f - x;
+            float dy = enemy.getY() + enemy.getHeight() / 2.0f - y;
+            float dist = std::sqrt(dx * dx + dy * dy);
+            if (dist < closestDist) {
+                closestDist = dist;
+                nearest = &enemy;
+            }
+        }
+        auto gridStart = Clock::now();
+        const LittlePurpleJumper* found = grid.findNearest(x, y, HOMING_RANGE);
+        auto gridEnd = Clock::now();
+        loopHomingSeconds += std::chrono::duration<double>(gridStart - queryStart).count();
+        gridHomingSeconds += std::chrono::duration<double>(gridEnd - gridStart).count();
+        if (found != nearest) homingMismatches++;
+    }
+
+    bool ok = loopHits == gridHits && homingMismatches == 0;
+    std::cout << "{\"mode\":\"enemies\""
+              << ",\"enemies\":" << ENEMIES
+              << ",\"grid_entries\":" << grid.getEntryCount()
+              << ",\"rebuild_ms\":" << rebuildSeconds * 1000.0
+              << ",\"hit_tests_per_sec_loop\":" << POINTS / loopHitSeconds
+              << ",\"hit_tests_per_sec_grid\":" << POINTS / gridHitSeconds
+              << ",\"homing_per_sec_loop\":" << HOMING_QUERIES / loopHomingSeconds
+              << ",\"homing_per_sec_grid\":" << HOMING_QUERIES / gridHomingSeconds
+              << ",\"hits_match\":" << (loopHits == gridHits ? "true" : "false")
+              << ",\"homing_mismatches\":" << homingMismatches
+              << "}" << std::endl;
+    return ok ? 0 : 1;
+}
+
+// Short segments, bullet steps at up to a few times Bullet::SPEED, through 1-pixel walls and
+// scattered particles. Each raycast hit is checked against dense sampling of the segment.
+int runRaycastBenchmark() {
+    constexpr int RAYS = 1000000;
+    constexpr int AREA_W = 480, AREA_H = 280;
+
+    Config config;
+    config.chunkGenerationThreads = 0;
+    config.persistDistantChunks = false;
+    std::ostringstream setupLog;
+    std::streambuf* stdoutBuffer = std::cout.rdbuf(setupLog.rdbuf());
+    World world(config);
+    setupWorld(world);
+    int left = (int)world.getCamera().x, top = (int)world.getCamera().y;
+    std::mt19937 rng(11);
+    for (int x = left + 8; x < left + AREA_W; x += 16) fillRect(world, x, top, 1, AREA_H, ParticleType::ROCK);
+    for (int y = top + 12; y < top + AREA_H; y += 24) fillRect(world, left, y, AREA_W, 1, ParticleType::ROCK);
+    std::uniform_int_distribution<int> scatterX(left, left + AREA_W - 1), scatterY(top, top + AREA_H - 1);
+    for (int i = 0; i < AREA_W * AREA_H / 50; ++i) world.spawnParticleAt(scatterX(rng), scatterY(rng), ParticleType::SAND);
+    std::cout.rdbuf(stdoutBuffer);
+
+    std::uniform_real_distribution<float> startX(left + 20.0f, left + AREA_W - 20.0f), startY(top + 20.0f, top + AREA_H - 20.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 6.2831853f), length(2.0f, 20.0f);
+    std::vector<float> rays(RAYS * 4);
+    for (int i = 0; i < RAYS; ++i) {
+        float x = startX(rng), y = startY(rng), a = angle(rng), l = length(rng);
+        rays[i * 4] = x;
+        rays[i * 4 + 1] = y;
+        rays[i * 4 + 2] = x + std::cos(a) * l;
+        rays[i * 4 + 3] = y + std::sin(a) * l;
+    }
+
+    // Old bullet path test: every 2 pixels, skipping the start
+    auto start = Clock::now();
+    std::vector<unsigned char> sampledHit(RAYS);
+    for (int i = 0; i < RAYS; ++i) {
+        float x = rays[i * 4], y = rays[i * 4 + 1];
+        float dx = rays[i * 4 + 2] - x, dy = rays[i * 4 + 3] - y;
+        int steps = std::max(1, (int)(std::sqrt(dx * dx + dy * dy) / 2.0f));
+        for (int s = 1; s <= steps && !sampledHit[i]; ++s) {
+            sampledHit[i] = world.isOccupied((int)(x + dx * s / steps), (int)(y + dy * s / steps));
+        }
+    }
+    double sampledSeconds = secondsSince(start);
+
+    start = Clock::now();
+    std::vector<RaycastHit> hits(RAYS);
+    std::vector<unsigned char> rayHit(RAYS);
+    for (int i = 0; i < RAYS; ++i) {
+        rayHit[i] = world.raycast(rays[i * 4], rays[i * 4 + 1], rays[i * 4 + 2], rays[i * 4 + 3], hits[i]);
+    }
+    double raycastSeconds = secondsSince(start);
+
+    // Dense sampling: no occupied cell (other than the start cell) before the hit, and none
+    // at all on segments without one. Points within a hair of a cell corner are left out.
+    int errors = 0, sampledHits = 0, raycastHits = 0, tunnelled = 0;
+    for (int i = 0; i < RAYS; ++i) {
+        float x = rays[i * 4], y = rays[i * 4 + 1];
+        float dx = rays[i * 4 + 2] - x, dy = rays[i * 4 + 3] - y;
+        float l = std::sqrt(dx * dx + dy * dy);
+        float limit = rayHit[i] ? hits[i].distance : l;
+        if (rayHit[i] && !world.isOccupied(hits[i].cellX, hits[i].cellY)) errors++;
+        for (double d = 0.0; d < limit - 0.01; d += 0.01) {
+            double px = x + dx * d / l, py = y + dy * d / l;
+            int cx = (int)std::floor(px), cy = (int)std::floor(py);
+            if (cx == (int)std::floor(x) && cy == (int)std::floor(y)) continue;
+            if (std::abs(px - std::round(px)) < 1e-3 && std::abs(py - std::round(py)) < 1e-3) continue;
+            if (world.isOccupied(cx, cy)) {
+                errors++;
+                break;
+            }
+        }
+        sampledHits += sampledHit[i];
+        raycastHits += rayHit[i];
+        if (rayHit[i] && !sampledHit[i]) tunnelled++;
+    }
+
+    std::cout << "{\"mode\":\"raycast\""
+              << ",\"rays\":" << RAYS
+              << ",\"sampled_per_sec\":" << RAYS / sampledSeconds
+              << ",\"raycast_per_sec\":" << RAYS / raycastSeconds
+              << ",\"sampled_hits\":" << sampledHits
+              << ",\"raycast_hits\":" << raycastHits
+              << ",\"missed_by_sampling\":" << tunnelled
+              << ",\"errors\":" << errors
+              << "}" << std::endl;
+    return errors == 0 ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string mode = argc > 1 ? argv[1] : "lookup";
+
+    if (mode == "lookup") {
+        runLookupBenchmark();
+    } else if (mode == "memory") {
+        runMemoryBenchmark();
+    } else if (mode == "region") {
+        return runRegionBenchmark();
+    } else if (mode == "palette") {
+        return runPaletteBenchmark();
+    } else if (mode == "render") {
+        return runRenderBenchmark();
+    } else if (mode == "simloop") {
+        return runSimulationLoopBenchmark();
+    } else if (mode == "offscreen") {
+        return runOffscreenBenchmark();
+    } else if (mode == "enemies") {
+        return runEnemyGridBenchmark();
+    } else if (mode == "raycast") {
+        return runRaycastBenchmark();
+    } else if (mode == "avalanche" || mode == "flood" || mode == "lava" || mode == "explosions" || mode == "freefall" || mode == "all" || mode == "determinism") {
+        ScenarioOptions options;
+        for (int i = 2; i + 1 < argc; i += 2) {
+            std::string flag = argv[i];
+            if (flag == "--ticks") options.ticks = std::max(1, std::atoi(argv[i + 1]));
+            else if (flag == "--seed") options.seed = (unsigned)std::strtoul(argv[i + 1], nullptr, 10);
+            else if (flag == "--scene") options.scene = argv[i + 1];
+        }
+
+        if (mode == "determinism") return runDeterminismCheck(options);
+
+        std::vector<std::string> scenarios = {"avalanche", "flood", "lava", "explosions", "freefall"};
+        if (mode != "all") scenarios = {mode};
+        for (const auto& scenario : scenarios) {
+            if (!runScenario(scenario, options)) return 1;
+        }
+    } else {
+        std::cerr << "Unknown benchmark: " << mode << std::endl;
+        std::cerr << "Usage: sand_bench [lookup|memory|region|palette|render|simloop|offscreen|enemies|raycast]" << std::endl;
+        std::cerr << "       sand_bench <avalanche|flood|lava|explosions|freefall|all|determinism> [--ticks N] [--seed N] [--scene file]" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
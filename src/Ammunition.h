@@ -7,7 +7,7 @@
 #include "World.h"
 #include "MainSprite.h"  // For SpriteRegion
 
-class LittlePurpleJumper;
+class EnemyGrid;
 class SpellModifier;
 class Sprite;
 
@@ -16,7 +16,7 @@ public:
     virtual ~Ammunition() = default;
 
     virtual void fire(World& world, float x, float y, float angle, int damage) = 0;
-    virtual void update(float deltaTime, World& world, std::vector<LittlePurpleJumper>& enemies) = 0;
+    virtual void update(float deltaTime, World& world, const EnemyGrid& enemies) = 0;
     virtual void render(SDL_Renderer* renderer, std::vector<Uint32>& pixels, int viewportWidth, int viewportHeight, float cameraX, float cameraY, float scaleX, float scaleY) = 0;
 
     virtual void cleanup() {}
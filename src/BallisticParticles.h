@@ -0,0 +1,49 @@
+#pragma once
+#include "SandSimulator.h"  // For ParticleType, ParticleColor
+#include <vector>
+
+// Particles in free flight, lifted out of the cell grid (World::explodeAt).
+//
+// Stored as parallel arrays, one entry per particle: the flight update only walks positions
+// and velocities, and the rest is read once, when a particle lands back in the grid.
+// Positions are in world cells (cell x covers x .. x+1), velocities in cells per tick.
+// Removal swaps the last particle into the gap, so order is not kept.
+class BallisticParticles {
+public:
+    std::vector<float> x, y;
+    std::vector<float> vx, vy;
+    std::vector<ParticleType> type;
+    std::vector<ParticleColor> color;
+    std::vector<float> temperature;
+
+    int size() const { return (int)x.size(); }
+    bool empty() const { return x.empty(); }
+
+    void add(float px, float py, float pvx, float pvy, ParticleType ptype, ParticleColor pcolor, float ptemperature) {
+        x.push_back(px);
+        y.push_back(py);
+        vx.push_back(pvx);
+        vy.push_back(pvy);
+        type.push_back(ptype);
+        color.push_back(pcolor);
+        temperature.push_back(ptemperature);
+    }
+
+    void remove(int i) {
+        int last = size() - 1;
+        x[i] = x[last];
+        y[i] = y[last];
+        vx[i] = vx[last];
+        vy[i] = vy[last];
+        type[i] = type[last];
+        color[i] = color[last];
+        temperature[i] = temperature[last];
+        x.pop_back();
+        y.pop_back();
+        vx.pop_back();
+        vy.pop_back();
+        type.pop_back();
+        color.pop_back();
+        temperature.pop_back();
+    }
+};
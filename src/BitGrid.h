@@ -0,0 +1,107 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Two-dimensional grid of bits, 64 to a word along x, each row starting on a new word.
+//
+// Single bits may be set or cleared from several threads at once (atomic OR/AND). Word
+// access is for passes that own the grid, such as World's sleep update: whole rows of bits
+// are combined with shifts and masks instead of being visited one cell at a time.
+class BitGrid {
+public:
+    static constexpr int WORD_BITS = 64;
+
+    BitGrid(int width, int height)
+        : width(width)
+        , height(height)
+        , wordsPerRow((width + WORD_BITS - 1) / WORD_BITS)
+        , words(wordsPerRow * height)
+    {
+    }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getWordsPerRow() const { return wordsPerRow; }
+
+    bool test(int x, int y) const {
+        return (word(x / WORD_BITS, y) >> (x % WORD_BITS)) & 1;
+    }
+
+    void set(int x, int y) {
+        std::atomic<uint64_t>& w = words[y * wordsPerRow + x / WORD_BITS];
+        uint64_t bit = 1ull << (x % WORD_BITS);
+        // Most calls find the bit already set: a plain load avoids the locked instruction
+        if (!(w.load(std::memory_order_relaxed) & bit)) w.fetch_or(bit, std::memory_order_relaxed);
+    }
+
+    void clear(int x, int y) {
+        words[y * wordsPerRow + x / WORD_BITS].fetch_and(~(1ull << (x % WORD_BITS)), std::memory_order_relaxed);
+    }
+
+    // Clear a bit and return whether it was set
+    bool take(int x, int y) {
+        std::atomic<uint64_t>& w = words[y * wordsPerRow + x / WORD_BITS];
+        uint64_t bit = 1ull << (x % WORD_BITS);
+        if (!(w.load(std::memory_order_relaxed) & bit)) return false;
+        return (w.fetch_and(~bit, std::memory_order_relaxed) & bit) != 0;
+    }
+
+    uint64_t word(int wordX, int y) const {
+        return words[y * wordsPerRow + wordX].load(std::memory_order_relaxed);
+    }
+
+    void setWord(int wordX, int y, uint64_t value) {
+        words[y * wordsPerRow + wordX].store(value, std::memory_order_relaxed);
+    }
+
+    // Bits of word wordX that lie in columns x0..x1 (inclusive)
+    static uint64_t columnMask(int wordX, int x0, int x1) {
+        int first = std::max(x0 - wordX * WORD_BITS, 0);
+        int last = std::min(x1 - wordX * WORD_BITS, WORD_BITS - 1);
+        if (first > last) return 0;
+        uint64_t upTo = last == WORD_BITS - 1 ? ~0ull : (1ull << (last + 1)) - 1;
+        return upTo & ~((1ull << first) - 1);
+    }
+
+    // Is any bit set in the rectangle x0..x1, y0..y1 (inclusive)?
+    bool any(int x0, int y0, int x1, int y1) const {
+        for (int y = y0; y <= y1; ++y) {
+            for (int wordX = x0 / WORD_BITS; wordX <= x1 / WORD_BITS; ++wordX) {
+                if (word(wordX, y) & columnMask(wordX, x0, x1)) return true;
+            }
+        }
+        return false;
+    }
+
+    // Set or clear every bit in the rectangle, clipped to the grid
+    void fill(int x0, int y0, int x1, int y1, bool value) {
+        x0 = std::max(x0, 0);
+        y0 = std::max(y0, 0);
+        x1 = std::min(x1, width - 1);
+        y1 = std::min(y1, height - 1);
+        for (int y = y0; y <= y1; ++y) {
+            for (int wordX = x0 / WORD_BITS; wordX <= x1 / WORD_BITS; ++wordX) {
+                uint64_t mask = columnMask(wordX, x0, x1);
+                std::atomic<uint64_t>& w = words[y * wordsPerRow + wordX];
+                if (value) w.fetch_or(mask, std::memory_order_relaxed);
+                else w.fetch_and(~mask, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Call fn(x) for each set bit of a word, lowest column first
+    template <typename Fn>
+    static void forEachBit(uint64_t bits, int wordX, Fn fn) {
+        while (bits) {
+            fn(wordX * WORD_BITS + __builtin_ctzll(bits));
+            bits &= bits - 1;
+        }
+    }
+
+private:
+    int width, height;
+    int wordsPerRow;
+    std::vector<std::atomic<uint64_t>> words;
+};
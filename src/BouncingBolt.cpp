@@ -1,4 +1,5 @@
 #include "BouncingBolt.h"
+#include "Random.h"
 #include "BulletConfig.h"
 #include "SpellModifier.h"
 #include <algorithm>
@@ -30,7 +31,7 @@ void BouncingBolt::fire(World& world, float x, float y, float angle, int damage)
             float totalSpread = spread * 2.0f;
             spreadAngle = -spread + (totalSpread * i / (projectileCount - 1));
         } else {
-            spreadAngle = spread * ((float)rand() / RAND_MAX - 0.5f);
+            spreadAngle = spread * (Random::local().uniform() - 0.5f);
         }
 
         float fireAngle = angle + spreadAngle;
@@ -46,7 +47,7 @@ void BouncingBolt::fire(World& world, float x, float y, float angle, int damage)
     }
 }
 
-void BouncingBolt::update(float deltaTime, World& world, std::vector<LittlePurpleJumper>& enemies) {
+void BouncingBolt::update(float deltaTime, World& world, const EnemyGrid& enemies) {
     for (auto& bullet : bullets) {
         if (!bullet.active) continue;
 
@@ -1,7 +1,7 @@
 #include "Bullet.h"
 #include "BulletConfig.h"
 #include "Sprite.h"
-#include "LittlePurpleJumper.h"
+#include "EnemyGrid.h"
 #include <SDL.h>
 #include <iostream>
 
@@ -21,7 +21,7 @@ void Bullet::applyConfig(const BulletTypeConfig& config) {
     frameTime = config.frameTime;
 }
 
-bool Bullet::update(World& world, float deltaTime, std::vector<LittlePurpleJumper>& enemies) {
+bool Bullet::update(World& world, float deltaTime, const EnemyGrid& enemies) {
     if (!active) return false;
 
     // Update lifetime
@@ -48,26 +48,11 @@ bool Bullet::update(World& world, float deltaTime, std::vector<LittlePurpleJumpe
 
     // Apply homing if enabled
     if (homingStrength > 0 && homingRange > 0) {
-        float closestDist = homingRange;
-        float targetX = 0, targetY = 0;
-        bool foundTarget = false;
-
-        for (auto& enemy : enemies) {
-            if (!enemy.isActive()) continue;
-            float ex = enemy.getX() + enemy.getWidth() / 2.0f;
-            float ey = enemy.getY() + enemy.getHeight() / 2.0f;
-            float dx = ex - x;
-            float dy = ey - y;
-            float dist = std::sqrt(dx * dx + dy * dy);
-            if (dist < closestDist) {
-                closestDist = dist;
-                targetX = ex;
-                targetY = ey;
-                foundTarget = true;
-            }
-        }
+        LittlePurpleJumper* target = enemies.findNearest(x, y, homingRange);
 
-        if (foundTarget) {
+        if (target) {
+            float targetX = target->getX() + target->getWidth() / 2.0f;
+            float targetY = target->getY() + target->getHeight() / 2.0f;
             float dx = targetX - x;
             float dy = targetY - y;
             float dist = std::sqrt(dx * dx + dy * dy);
@@ -94,71 +79,58 @@ bool Bullet::update(World& world, float deltaTime, std::vector<LittlePurpleJumpe
     float newX = x + vx * deltaTime;
     float newY = y + vy * deltaTime;
 
-    // Check for collision along the path (simple raycast)
+    // First particle on the path, cell by cell. The cell the bullet is in is skipped, so it
+    // does not collide with trail particles spawned at its current position.
+    RaycastHit hit;
+    bool hitParticle = world.raycast(x, y, newX, newY, hit);
+
+    // Enemies along the path up to that particle, checked every 2 pixels
     float currentSpeed = std::sqrt(vx * vx + vy * vy);
-    int steps = std::max(1, (int)(currentSpeed * deltaTime / 2.0f)); // Check every 2 pixels
+    float pathLength = currentSpeed * deltaTime;
+    int steps = std::max(1, (int)(pathLength / 2.0f));
     float stepX = (newX - x) / steps;
     float stepY = (newY - y) / steps;
 
-    // Start from i=1 to skip collision check at starting position
-    // This prevents bullets from colliding with trail particles spawned at their current pos
     for (int i = 1; i <= steps; i++) {
+        if (hitParticle && pathLength * i / steps >= hit.distance) break;
         int checkX = (int)(x + stepX * i);
         int checkY = (int)(y + stepY * i);
 
-        // Check for collision with scene objects (enemies)
-        for (auto& enemy : enemies) {
-            if (enemy.isActive() && checkX >= enemy.getX() && checkX < enemy.getX() + enemy.getWidth() &&
-                checkY >= enemy.getY() && checkY < enemy.getY() + enemy.getHeight()) {
-                enemy.takeDamage(damage);
-
-                // Handle piercing
-                if (piercesRemaining > 0) {
-                    piercesRemaining--;
-                    // Continue through enemy, don't deactivate
-                    continue;
-                }
-
-                active = false;
-                return true;
-            }
-        }
+        // Check for collision with enemies (only those in this spot's bucket)
+        enemies.forEachAt(checkX, checkY, [&](LittlePurpleJumper& enemy) {
+            enemy.takeDamage(damage);
 
-        // Check for particle hit
-        if (world.isOccupied(checkX, checkY)) {
-            // Handle bouncing
-            if (bouncesRemaining > 0) {
-                bouncesRemaining--;
-
-                // Determine bounce direction by checking adjacent cells
-                bool solidLeft = world.isOccupied(checkX - 1, checkY);
-                bool solidRight = world.isOccupied(checkX + 1, checkY);
-                bool solidUp = world.isOccupied(checkX, checkY - 1);
-                bool solidDown = world.isOccupied(checkX, checkY + 1);
-
-                // Reverse appropriate velocity component
-                if ((solidLeft && vx < 0) || (solidRight && vx > 0)) {
-                    vx = -vx;
-                }
-                if ((solidUp && vy < 0) || (solidDown && vy > 0)) {
-                    vy = -vy;
-                }
-
-                // If can't determine direction, just reverse both
-                if (!solidLeft && !solidRight && !solidUp && !solidDown) {
-                    vx = -vx;
-                    vy = -vy;
-                }
-
-                // Move back slightly to avoid getting stuck
-                x = x + stepX * (i - 1);
-                y = y + stepY * (i - 1);
+            // Handle piercing
+            if (piercesRemaining > 0) {
+                piercesRemaining--;
+                // Continue through enemy, don't deactivate
                 return false;
             }
 
             active = false;
             return true;
+        });
+        if (!active) return true;
+    }
+
+    if (hitParticle) {
+        // Handle bouncing
+        if (bouncesRemaining > 0) {
+            bouncesRemaining--;
+
+            // Reflect off the face the path entered the particle through
+            if (hit.normalX != 0) vx = -vx;
+            if (hit.normalY != 0) vy = -vy;
+
+            // Stop just short of the surface to avoid getting stuck
+            float back = std::max(0.0f, hit.distance - 0.5f) / pathLength;
+            x += (newX - x) * back;
+            y += (newY - y) * back;
+            return false;
         }
+
+        active = false;
+        return true;
     }
 
     x = newX;
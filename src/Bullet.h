@@ -5,7 +5,7 @@
 #include "MainSprite.h"
 #include <cmath>
 
-class LittlePurpleJumper;
+class EnemyGrid;
 class Sprite;
 struct BulletTypeConfig;
 
@@ -55,7 +55,7 @@ struct Bullet {
     // Apply configuration from BulletConfig
     void applyConfig(const BulletTypeConfig& config);
 
-    bool update(World& world, float deltaTime, std::vector<LittlePurpleJumper>& enemies);
+    bool update(World& world, float deltaTime, const EnemyGrid& enemies);
 
     // Draw bullet - uses sprite if available, otherwise falls back to color
     void draw(std::vector<Uint32>& pixels, int viewportWidth, int viewportHeight,
@@ -0,0 +1,44 @@
+#include "ChunkCanvas.h"
+#include "World.h"
+
+ChunkCanvas::ChunkCanvas(const World& world, WorldChunk& chunk)
+    : world(world)
+    , chunk(chunk)
+    , originX(chunk.getWorldX())
+    , originY(chunk.getWorldY())
+{
+}
+
+const Config& ChunkCanvas::getConfig() const {
+    return world.getConfig();
+}
+
+bool ChunkCanvas::inWorldBounds(int worldX, int worldY) const {
+    return world.inWorldBounds(worldX, worldY);
+}
+
+ParticleType ChunkCanvas::getParticle(int worldX, int worldY) const {
+    if (inChunk(worldX, worldY)) {
+        return chunk.getParticle(worldX - originX, worldY - originY);
+    }
+    return world.getSceneParticle(worldX, worldY);
+}
+
+ParticleColor ChunkCanvas::getColor(int worldX, int worldY) const {
+    if (inChunk(worldX, worldY)) {
+        return chunk.getColor(worldX - originX, worldY - originY);
+    }
+    return {0, 0, 0};
+}
+
+void ChunkCanvas::setParticle(int worldX, int worldY, ParticleType type) {
+    if (inChunk(worldX, worldY)) {
+        chunk.setParticle(worldX - originX, worldY - originY, type);
+    }
+}
+
+void ChunkCanvas::setColor(int worldX, int worldY, ParticleColor color) {
+    if (inChunk(worldX, worldY)) {
+        chunk.setColor(worldX - originX, worldY - originY, color);
+    }
+}
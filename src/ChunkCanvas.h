@@ -0,0 +1,33 @@
+#pragma once
+#include "SandSimulator.h"  // For ParticleType, ParticleColor
+#include "WorldChunk.h"
+#include "Config.h"
+
+class World;
+
+// World view used while generating one chunk. The chunk may be a staging chunk on a
+// generation thread, so the live world is never touched: cells inside the chunk are read
+// and written directly, cells outside it read as the terrain the scene image puts there,
+// and writes outside the chunk are dropped.
+class ChunkCanvas {
+public:
+    ChunkCanvas(const World& world, WorldChunk& chunk);
+
+    WorldChunk& getChunk() { return chunk; }
+    const Config& getConfig() const;
+
+    bool inWorldBounds(int worldX, int worldY) const;
+    ParticleType getParticle(int worldX, int worldY) const;
+    ParticleColor getColor(int worldX, int worldY) const;
+    void setParticle(int worldX, int worldY, ParticleType type);
+    void setColor(int worldX, int worldY, ParticleColor color);
+
+private:
+    const World& world;
+    WorldChunk& chunk;
+    int originX, originY;  // World position of the chunk's top-left cell
+
+    bool inChunk(int worldX, int worldY) const {
+        return WorldChunk::inBounds(worldX - originX, worldY - originY);
+    }
+};
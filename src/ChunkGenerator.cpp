@@ -0,0 +1,109 @@
+#include "ChunkGenerator.h"
+
+ChunkGenerator::ChunkGenerator(const World& world, int threadCount) : world(world) {
+    for (int i = 0; i < threadCount; ++i) {
+        workers.emplace_back(&ChunkGenerator::workerLoop, this);
+    }
+}
+
+ChunkGenerator::~ChunkGenerator() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        queue.clear();
+    }
+    workAvailable.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ChunkGenerator::beginRequests() {
+    std::lock_guard<std::mutex> lock(mutex);
+    currentRound++;
+}
+
+void ChunkGenerator::request(int chunkX, int chunkY, bool populateFromScene, float priority) {
+    int64_t key = makeKey(chunkX, chunkY);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = queue.find(key);
+        if (it != queue.end()) {
+            it->second.populateFromScene = populateFromScene;
+            it->second.priority = priority;
+            it->second.round = currentRound;
+            return;
+        }
+        if (!pendingKeys.insert(key).second) return;  // Running
+        queue[key] = {chunkX, chunkY, populateFromScene, priority, currentRound};
+    }
+    workAvailable.notify_one();
+}
+
+bool ChunkGenerator::isPending(int chunkX, int chunkY) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pendingKeys.count(makeKey(chunkX, chunkY)) > 0;
+}
+
+void ChunkGenerator::collect(std::vector<GeneratedChunk>& out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& result : results) {
+        pendingKeys.erase(makeKey(result.chunk->getChunkX(), result.chunk->getChunkY()));
+        out.push_back(std::move(result));
+    }
+    results.clear();
+}
+
+void ChunkGenerator::cancelAll() {
+    std::unique_lock<std::mutex> lock(mutex);
+    queue.clear();
+    jobFinished.wait(lock, [&] { return runningJobs == 0; });
+    results.clear();
+    pendingKeys.clear();
+}
+
+void ChunkGenerator::workerLoop() {
+    while (true) {
+        Request job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workAvailable.wait(lock, [&] { return stopping || !queue.empty(); });
+            if (stopping) return;
+            if (!takeNextRequest(job)) continue;
+            runningJobs++;
+        }
+
+        GeneratedChunk result;
+        result.populatedFromScene = job.populateFromScene;
+        result.chunk = world.generateChunk(job.chunkX, job.chunkY, job.populateFromScene, result.spawnPoints);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            results.push_back(std::move(result));
+            runningJobs--;
+        }
+        jobFinished.notify_all();
+    }
+}
+
+bool ChunkGenerator::takeNextRequest(Request& job) {
+    // Drop requests the last full round did not repeat, pick the most urgent of the rest
+    auto best = queue.end();
+    for (auto it = queue.begin(); it != queue.end();) {
+        if (it->second.round < currentRound - 1) {
+            pendingKeys.erase(it->first);
+            it = queue.erase(it);
+            continue;
+        }
+        if (best == queue.end() || it->second.priority < best->second.priority) {
+            best = it;
+        }
+        ++it;
+    }
+    if (best == queue.end()) return false;
+
+    job = best->second;
+    queue.erase(best);
+    return true;
+}
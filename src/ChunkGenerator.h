@@ -0,0 +1,62 @@
+#pragma once
+#include "World.h"
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Worker pool that builds new chunks off the main thread. Each job generates into its
+// own staging chunk through World::generateChunk (which never touches live chunks);
+// finished chunks wait in a result list until the main thread collects and publishes them.
+//
+// Requests are made in rounds (one per frame): workers take the lowest priority value
+// first, and a queued request that is not repeated in the following round is dropped.
+class ChunkGenerator {
+public:
+    ChunkGenerator(const World& world, int threadCount);
+    ~ChunkGenerator();
+
+    // Start a new round of requests
+    void beginRequests();
+
+    // Queue a chunk, or renew it with a new priority if it is already queued. Lower values
+    // are generated first; ignored while the chunk is being generated.
+    void request(int chunkX, int chunkY, bool populateFromScene, float priority);
+    bool isPending(int chunkX, int chunkY) const;
+
+    // Move finished chunks into out (main thread)
+    void collect(std::vector<GeneratedChunk>& out);
+
+    // Drop queued requests and unpublished results, waiting for running jobs to finish.
+    // Call before changing anything generation reads (e.g. the scene image).
+    void cancelAll();
+
+private:
+    struct Request {
+        int chunkX, chunkY;
+        bool populateFromScene;
+        float priority;
+        int round;
+    };
+
+    const World& world;
+    std::vector<std::thread> workers;
+
+    mutable std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable jobFinished;
+    std::unordered_map<int64_t, Request> queue;
+    std::unordered_set<int64_t> pendingKeys;  // Queued or running
+    int currentRound = 0;
+    std::vector<GeneratedChunk> results;
+    int runningJobs = 0;
+    bool stopping = false;
+
+    static int64_t makeKey(int chunkX, int chunkY) { return ((int64_t)chunkY << 32) | (uint32_t)chunkX; }
+    void workerLoop();
+    bool takeNextRequest(Request& job);  // Must be called with mutex held
+};
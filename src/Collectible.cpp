@@ -1,4 +1,5 @@
 #include "Collectible.h"
+#include "Random.h"
 #include <iostream>
 #include <cmath>
 #include <cstdlib>
@@ -128,10 +129,10 @@ void Collectible::triggerExplosion() {
                 float dx = p.x - centerX;
                 float dy = p.y - centerY;
                 float dist = std::sqrt(dx * dx + dy * dy) + 0.1f;
-                float speed = 50.0f + (rand() % 100);
+                float speed = 50.0f + Random::local().below(100);
 
-                p.vx = (dx / dist) * speed + (rand() % 40 - 20);
-                p.vy = (dy / dist) * speed + (rand() % 40 - 20) - 30.0f;  // Slight upward bias
+                p.vx = (dx / dist) * speed + Random::local().range(-20, 19);
+                p.vy = (dy / dist) * speed + Random::local().range(-20, 19) - 30.0f;  // Slight upward bias
 
                 p.r = r;
                 p.g = g;
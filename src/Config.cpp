@@ -23,6 +23,20 @@ void Config::setDefaults() {
     wetnessSpreadRate = 0.1f;      // 10% spread per frame (10x faster than before)
     wetnessMinimumThreshold = 0.05f;  // Only spread if wetness > 5% (prevents micro-wetness processing)
 
+    // World simulation defaults
+    parallelSimulation = true;
+    persistDistantChunks = true;
+    regionCacheDir = "region_cache";
+    chunkGenerationThreads = 2;
+    chunkPrefetchSeconds = 1.5f;
+    worldSeed = 0;
+    simulationStepsPerSecond = 60;
+    simulationMaxCatchUpSteps = 4;
+    simulationThread = true;
+    offscreenSimulationInterval = 3;
+    offscreenSimulationBudgetMs = 2.0f;
+    heatSimulationInterval = 4;
+
     // Sand defaults
     sand.colorR = 255;
     sand.colorG = 200;
@@ -104,6 +104,20 @@ struct Config {
     float wetnessSpreadRate;       // How fast wetness spreads between particles (0.0-1.0 per frame)
     float wetnessMinimumThreshold; // Minimum wetness needed before spreading occurs (optimization)
 
+    // World simulation
+    bool parallelSimulation;       // Update particle tiles on all cores (checkerboard phases)
+    bool persistDistantChunks;     // Evict distant non-empty chunks to the region cache instead of keeping them
+    std::string regionCacheDir;    // Directory for the per-session region cache files
+    int chunkGenerationThreads;    // Background workers generating the load ring (0 = generate on demand)
+    float chunkPrefetchSeconds;    // Generate chunks the moving camera will reach within this many seconds first
+    unsigned worldSeed;            // Seed for simulation and generation randomness (0 = from the clock)
+    int simulationStepsPerSecond;  // Fixed simulation rate (0 = particles are not simulated)
+    int simulationMaxCatchUpSteps; // Steps run back to back when behind; any older backlog is skipped
+    bool simulationThread;         // Step the simulation on its own thread instead of in the frame loop
+    int offscreenSimulationInterval;   // Ticks between updates of loaded off-screen particles (0 = they freeze)
+    float offscreenSimulationBudgetMs; // Time per tick for off-screen particles; the rest wait (0 = no limit)
+    int heatSimulationInterval;    // Ticks between heat diffusion passes (0 = no heat transfer)
+
     ParticleTypeConfig sand;
     ParticleTypeConfig water;
     ParticleTypeConfig rock;
@@ -0,0 +1,66 @@
+#include "EnemyGrid.h"
+
+void EnemyGrid::rebuild(std::vector<LittlePurpleJumper>& enemyList) {
+    enemies = &enemyList;
+    entries.clear();
+
+    for (int i = 0; i < (int)enemyList.size(); ++i) {
+        const LittlePurpleJumper& enemy = enemyList[i];
+        if (!enemy.isActive()) continue;
+
+        int x0 = bucketX(enemy.getX());
+        int y0 = bucketY(enemy.getY());
+        int x1 = bucketX(enemy.getX() + enemy.getWidth());
+        int y1 = bucketY(enemy.getY() + enemy.getHeight());
+        for (int by = y0; by <= y1; ++by) {
+            for (int bx = x0; bx <= x1; ++bx) {
+                entries.push_back({by * BUCKETS_X + bx, i});
+            }
+        }
+    }
+
+    // Entries were added in enemy order, which the stable sort keeps within each bucket
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const Entry& a, const Entry& b) { return a.bucket < b.bucket; });
+}
+
+int EnemyGrid::firstEntry(int bucket) const {
+    auto it = std::lower_bound(entries.begin(), entries.end(), bucket,
+                               [](const Entry& entry, int value) { return entry.bucket < value; });
+    return (int)(it - entries.begin());
+}
+
+LittlePurpleJumper* EnemyGrid::findNearest(float x, float y, float range) const {
+    if (!enemies || entries.empty()) return nullptr;
+
+    float closestDist = range;
+    int closest = -1;
+    auto consider = [&](int index) {
+        const LittlePurpleJumper& enemy = (*enemies)[index];
+        if (!enemy.isActive()) return;
+        float dx = enemy.getX() + enemy.getWidth() / 2.0f - x;
+        float dy = enemy.getY() + enemy.getHeight() / 2.0f - y;
+        float dist = std::sqrt(dx * dx + dy * dy);
+        if (dist < closestDist || (dist == closestDist && closest >= 0 && index < closest)) {
+            closestDist = dist;
+            closest = index;
+        }
+    };
+
+    // A centre within range lies in a bucket of the square around (x, y). When that square
+    // covers more buckets than there are entries, looking at every enemy is cheaper.
+    int x0 = bucketX(x - range), x1 = bucketX(x + range);
+    int y0 = bucketY(y - range), y1 = bucketY(y + range);
+    if ((int64_t)(x1 - x0 + 1) * (y1 - y0 + 1) > (int64_t)entries.size()) {
+        for (int i = 0; i < (int)enemies->size(); ++i) consider(i);
+    } else {
+        // The buckets of a row of the square are consecutive: one search per row
+        for (int by = y0; by <= y1; ++by) {
+            int lastBucket = by * BUCKETS_X + x1;
+            for (int i = firstEntry(by * BUCKETS_X + x0); i < (int)entries.size() && entries[i].bucket <= lastBucket; ++i) {
+                consider(entries[i].enemy);
+            }
+        }
+    }
+    return closest >= 0 ? &(*enemies)[closest] : nullptr;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "LittlePurpleJumper.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Uniform grid over the enemies, rebuilt once a frame after they move, so that bullet hit
+// tests and homing only look at enemies near the bullet.
+//
+// Each enemy is listed in every CELL_SIZE x CELL_SIZE bucket its box overlaps. The lists are
+// one array of (bucket, enemy index) entries sorted by bucket, so a rebuild is a sort and a
+// bucket is found by binary search. Queries see enemies in the order of the enemy vector,
+// like a loop over it would. The vector must not change size between rebuild() and the last
+// query of the frame.
+class EnemyGrid {
+public:
+    static constexpr int CELL_SIZE = 64;  // World cells per bucket side
+    static constexpr int BUCKETS_X = World::WORLD_WIDTH / CELL_SIZE;
+    static constexpr int BUCKETS_Y = World::WORLD_HEIGHT / CELL_SIZE;
+
+    void rebuild(std::vector<LittlePurpleJumper>& enemies);
+
+    // Call fn(enemy) for each active enemy whose box contains cell (x, y), until fn returns true
+    template <typename Fn>
+    void forEachAt(int x, int y, Fn fn) const {
+        int bucket = bucketY((float)y) * BUCKETS_X + bucketX((float)x);
+        for (int i = firstEntry(bucket); i < (int)entries.size() && entries[i].bucket == bucket; ++i) {
+            LittlePurpleJumper& enemy = (*enemies)[entries[i].enemy];
+            if (enemy.isActive() && x >= enemy.getX() && x < enemy.getX() + enemy.getWidth() &&
+                y >= enemy.getY() && y < enemy.getY() + enemy.getHeight()) {
+                if (fn(enemy)) return;
+            }
+        }
+    }
+
+    // Active enemy whose centre is nearest to (x, y) and closer than range, or nullptr
+    // (the first in the enemy vector on a tie)
+    LittlePurpleJumper* findNearest(float x, float y, float range) const;
+
+    int getEntryCount() const { return (int)entries.size(); }
+
+private:
+    struct Entry {
+        int bucket;
+        int enemy;  // Index into the enemy vector
+    };
+
+    std::vector<LittlePurpleJumper>* enemies = nullptr;
+    std::vector<Entry> entries;
+
+    // Positions outside the world fall into the edge buckets
+    static int bucketX(float x) { return std::clamp((int)std::floor(x / CELL_SIZE), 0, BUCKETS_X - 1); }
+    static int bucketY(float y) { return std::clamp((int)std::floor(y / CELL_SIZE), 0, BUCKETS_Y - 1); }
+    int firstEntry(int bucket) const;
+};
@@ -1,4 +1,5 @@
 #include "FireBolt.h"
+#include "Random.h"
 #include "BulletConfig.h"
 #include "SpellModifier.h"
 #include <algorithm>
@@ -25,7 +26,7 @@ void FireBolt::fire(World& world, float x, float y, float angle, int damage) {
     const auto& cfg = BulletConfigs::FireBolt;
 
     for (int i = 0; i < projectileCount; ++i) {
-        float spreadAngle = spread * ((float)rand() / RAND_MAX - 0.5f);
+        float spreadAngle = spread * (Random::local().uniform() - 0.5f);
         float fireAngle = angle + spreadAngle;
 
         Bullet bullet(x, y, std::cos(fireAngle), std::sin(fireAngle), damage);
@@ -40,7 +41,7 @@ void FireBolt::fire(World& world, float x, float y, float angle, int damage) {
     }
 }
 
-void FireBolt::update(float deltaTime, World& world, std::vector<LittlePurpleJumper>& enemies) {
+void FireBolt::update(float deltaTime, World& world, const EnemyGrid& enemies) {
     fireSpawnTimer += deltaTime;
 
     for (auto& bullet : bullets) {
@@ -1,5 +1,5 @@
 #include "Gun.h"
-#include "LittlePurpleJumper.h"
+#include "Random.h"
 #include <iostream>
 #include <SDL.h> // For SDL_GetTicks()
 
@@ -175,7 +175,7 @@ bool Gun::fire(World& world) {
 
     // Apply wand spread
     float wandSpread = stats.spreadDegrees * (3.14159f / 180.0f);
-    float fireAngle = angle + wandSpread * ((float)rand() / RAND_MAX - 0.5f);
+    float fireAngle = angle + wandSpread * (Random::local().uniform() - 0.5f);
 
     // Apply wand damage multiplier
     int finalDamage = (int)(damage * stats.damageMultiplier);
@@ -254,7 +254,7 @@ void Gun::clearAmmunition() {
     ammunition.clear();
 }
 
-void Gun::updateAmmunition(float deltaTime, World& world, std::vector<LittlePurpleJumper>& enemies) {
+void Gun::updateAmmunition(float deltaTime, World& world, const EnemyGrid& enemies) {
     for (auto& ammo : ammunition) {
         ammo->update(deltaTime, world, enemies);
     }
@@ -6,7 +6,7 @@
 #include <memory>
 #include <string>
 
-class LittlePurpleJumper;
+class EnemyGrid;
 class Sprite;
 
 // Noita-style wand stats
@@ -72,7 +72,7 @@ public:
 
     // Update and render
     void update(float deltaTime);  // Update mana recharge, etc.
-    void updateAmmunition(float deltaTime, World& world, std::vector<LittlePurpleJumper>& enemies);
+    void updateAmmunition(float deltaTime, World& world, const EnemyGrid& enemies);
     void renderAmmunition(SDL_Renderer* renderer, std::vector<Uint32>& pixels, int viewportWidth, int viewportHeight, float cameraX, float cameraY, float scaleX, float scaleY);
 
     // Mana system
@@ -0,0 +1,236 @@
+#include "LevelFile.h"
+#include "World.h"
+#include "ScenePalette.h"
+#include "stb_image.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static constexpr int TILE_SIZE = WorldChunk::CHUNK_SIZE;
+static constexpr int TILE_CELLS = TILE_SIZE * TILE_SIZE;
+static constexpr uint64_t TILE_ALIGNMENT = 4096;  // Cell data starts on a page boundary
+
+LevelFile::~LevelFile() {
+    close();
+}
+
+bool LevelFile::bake(const std::string& imagePath, const std::string& levelPath) {
+    int width, height, channels;
+    unsigned char* image = stbi_load(imagePath.c_str(), &width, &height, &channels, 3);
+    if (!image) {
+        std::cerr << "Failed to load scene image: " << imagePath << std::endl;
+        return false;
+    }
+
+    ScenePalette palette(ScenePalette::SCENE_DARK_CUTOFF, ScenePalette::SCENE_MATCH_THRESHOLD);
+
+    // Image Y=0 corresponds to world Y = WORLD_HEIGHT - height
+    int imageBaseY = World::WORLD_HEIGHT - height;
+
+    Header header;
+    std::memcpy(header.magic, "LVL1", 4);
+    header.tileSize = TILE_SIZE;
+    header.firstChunkX = 0;
+    header.firstChunkY = std::max(0, imageBaseY) / TILE_SIZE;
+    header.chunksX = std::min((width + TILE_SIZE - 1) / TILE_SIZE, World::WORLD_CHUNKS_X);
+    header.chunksY = World::WORLD_CHUNKS_Y - header.firstChunkY;
+
+    std::vector<TileEntry> entries(header.chunksX * header.chunksY);
+    std::ofstream out(levelPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Failed to create level file: " << levelPath << std::endl;
+        stbi_image_free(image);
+        return false;
+    }
+
+    // Table first (rewritten once the tiles are placed), then the tiles
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(TileEntry));
+    uint64_t offset = sizeof(header) + entries.size() * sizeof(TileEntry);
+
+    auto padTo = [&](uint64_t alignment) {
+        static const char zeros[TILE_ALIGNMENT] = {};
+        uint64_t padding = (alignment - offset % alignment) % alignment;
+        out.write(zeros, padding);
+        offset += padding;
+    };
+
+    std::vector<unsigned char> types(TILE_CELLS);
+    std::vector<Marker> markers;
+    int tilesWithCells = 0;
+    int markerTotal = 0;
+
+    for (int ty = 0; ty < header.chunksY; ty++) {
+        for (int tx = 0; tx < header.chunksX; tx++) {
+            int chunkWorldX = (header.firstChunkX + tx) * TILE_SIZE;
+            int chunkWorldY = (header.firstChunkY + ty) * TILE_SIZE;
+            markers.clear();
+
+            for (int localY = 0; localY < TILE_SIZE; localY++) {
+                for (int localX = 0; localX < TILE_SIZE; localX++) {
+                    int imageX = chunkWorldX + localX;
+                    int imageY = chunkWorldY + localY - imageBaseY;
+                    unsigned char type = (unsigned char)ParticleType::EMPTY;
+
+                    if (imageX < width && imageY >= 0 && imageY < height) {
+                        const unsigned char* pixel = image + ((size_t)imageY * width + imageX) * 3;
+                        type = palette.classify(pixel[0], pixel[1], pixel[2]);
+                        if (type == ScenePalette::JUMPER_MARKER) {
+                            markers.push_back({(uint16_t)localX, (uint16_t)localY, (uint32_t)SpawnMarkerType::LITTLE_PURPLE_JUMPER});
+                            type = (unsigned char)ParticleType::EMPTY;
+                        }
+                    }
+                    types[localY * TILE_SIZE + localX] = type;
+                }
+            }
+
+            TileEntry& entry = entries[ty * header.chunksX + tx];
+            entry.fillType = types[0];
+            if (std::count(types.begin(), types.end(), types[0]) != TILE_CELLS) {
+                padTo(TILE_ALIGNMENT);
+                entry.typesOffset = offset;
+                out.write(reinterpret_cast<const char*>(types.data()), TILE_CELLS);
+                offset += TILE_CELLS;
+                tilesWithCells++;
+            }
+
+            if (!markers.empty()) {
+                padTo(alignof(Marker));
+                entry.markersOffset = offset;
+                entry.markerCount = (uint32_t)markers.size();
+                out.write(reinterpret_cast<const char*>(markers.data()), markers.size() * sizeof(Marker));
+                offset += markers.size() * sizeof(Marker);
+                markerTotal += (int)markers.size();
+            }
+        }
+    }
+
+    out.seekp(sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(TileEntry));
+    stbi_image_free(image);
+
+    if (!out) {
+        std::cerr << "Failed to write level file: " << levelPath << std::endl;
+        return false;
+    }
+
+    std::cout << "Baked " << imagePath << " (" << width << "x" << height << ") into " << levelPath << ": "
+              << entries.size() << " tiles, " << tilesWithCells << " with cell data, " << markerTotal
+              << " spawn markers, " << offset / (1024 * 1024) << " MB" << std::endl;
+    return true;
+}
+
+bool LevelFile::open(const std::string& path) {
+    close();
+
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Failed to open level file: " << path << std::endl;
+        return false;
+    }
+
+    struct stat info;
+    void* mapped = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Failed to map level file: " << path << std::endl;
+        return false;
+    }
+    data = static_cast<const unsigned char*>(mapped);
+    size = info.st_size;
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        std::cerr << "Failed to open level file: " << path << std::endl;
+        return false;
+    }
+    fallbackData.resize((size_t)in.tellg());
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(fallbackData.data()), fallbackData.size());
+    data = fallbackData.data();
+    size = fallbackData.size();
+#endif
+
+    // Validate the header and every table entry up front so lookups need no bounds checks
+    bool valid = size >= sizeof(Header) && std::memcmp(header()->magic, "LVL1", 4) == 0 &&
+                 header()->tileSize == TILE_SIZE && header()->chunksX >= 0 && header()->chunksY >= 0;
+    valid = valid && sizeof(Header) + (uint64_t)header()->chunksX * header()->chunksY * sizeof(TileEntry) <= size;
+
+    const TileEntry* entries = reinterpret_cast<const TileEntry*>(data + sizeof(Header));
+    for (int i = 0; valid && i < header()->chunksX * header()->chunksY; i++) {
+        const TileEntry& entry = entries[i];
+        if (entry.typesOffset != 0 && entry.typesOffset + TILE_CELLS > size) valid = false;
+        if (entry.markerCount != 0 && entry.markersOffset + (uint64_t)entry.markerCount * sizeof(Marker) > size) valid = false;
+    }
+
+    if (!valid) {
+        std::cerr << "Invalid level file: " << path << std::endl;
+        close();
+        return false;
+    }
+
+    std::cout << "Level loaded: " << path << " (" << header()->chunksX << "x" << header()->chunksY << " chunks)" << std::endl;
+    return true;
+}
+
+void LevelFile::close() {
+#ifndef _WIN32
+    if (data && fallbackData.empty()) {
+        munmap(const_cast<unsigned char*>(data), size);
+    }
+#endif
+    fallbackData.clear();
+    data = nullptr;
+    size = 0;
+}
+
+const LevelFile::TileEntry* LevelFile::findTile(int chunkX, int chunkY) const {
+    if (!data) return nullptr;
+
+    int tx = chunkX - header()->firstChunkX;
+    int ty = chunkY - header()->firstChunkY;
+    if (tx < 0 || tx >= header()->chunksX || ty < 0 || ty >= header()->chunksY) return nullptr;
+
+    const TileEntry* entries = reinterpret_cast<const TileEntry*>(data + sizeof(Header));
+    return &entries[ty * header()->chunksX + tx];
+}
+
+const unsigned char* LevelFile::getTileTypes(int chunkX, int chunkY, ParticleType& fillType) const {
+    fillType = ParticleType::EMPTY;
+    const TileEntry* entry = findTile(chunkX, chunkY);
+    if (!entry) return nullptr;
+
+    fillType = (ParticleType)entry->fillType;
+    return entry->typesOffset ? data + entry->typesOffset : nullptr;
+}
+
+const LevelFile::Marker* LevelFile::getTileMarkers(int chunkX, int chunkY, int& count) const {
+    count = 0;
+    const TileEntry* entry = findTile(chunkX, chunkY);
+    if (!entry || entry->markerCount == 0) return nullptr;
+
+    count = (int)entry->markerCount;
+    return reinterpret_cast<const Marker*>(data + entry->markersOffset);
+}
+
+ParticleType LevelFile::getParticle(int worldX, int worldY) const {
+    if (worldX < 0 || worldY < 0) return ParticleType::EMPTY;
+
+    ParticleType fillType;
+    const unsigned char* types = getTileTypes(worldX / TILE_SIZE, worldY / TILE_SIZE, fillType);
+    if (!types) return fillType;
+    return (ParticleType)types[(worldY % TILE_SIZE) * TILE_SIZE + worldX % TILE_SIZE];
+}
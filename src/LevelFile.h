@@ -0,0 +1,63 @@
+#pragma once
+#include "SandSimulator.h"  // For ParticleType
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Baked scene level (.lvl): the scene image classified offline into one particle-type byte
+// per cell, stored in chunk-sized tiles together with each tile's spawn markers.
+//
+// The file is memory-mapped, so loading it decodes nothing and only the tiles that are
+// read become resident. Tiles filled with a single type (usually empty space) store no
+// cell data. Bake with the level_bake tool.
+class LevelFile {
+public:
+    // Spawn marker, in cells relative to the tile's top-left corner
+    struct Marker {
+        uint16_t localX, localY;
+        uint32_t type;  // SpawnMarkerType
+    };
+
+    LevelFile() = default;
+    ~LevelFile();
+    LevelFile(const LevelFile&) = delete;
+    LevelFile& operator=(const LevelFile&) = delete;
+
+    // Classify a scene image and write it as a level file. The image is placed the way
+    // World::setSceneImage places it: bottom-left corner of the world.
+    static bool bake(const std::string& imagePath, const std::string& levelPath);
+
+    bool open(const std::string& path);
+    bool isOpen() const { return data != nullptr; }
+
+    // Cell types of a chunk, CHUNK_SIZE x CHUNK_SIZE row-major. Returns nullptr when the
+    // whole chunk is fillType (EMPTY outside the level).
+    const unsigned char* getTileTypes(int chunkX, int chunkY, ParticleType& fillType) const;
+    const Marker* getTileMarkers(int chunkX, int chunkY, int& count) const;
+
+    ParticleType getParticle(int worldX, int worldY) const;
+
+private:
+    struct Header {
+        char magic[4];  // "LVL1"
+        int32_t tileSize;
+        int32_t firstChunkX, firstChunkY;
+        int32_t chunksX, chunksY;
+    };
+
+    struct TileEntry {
+        uint64_t typesOffset;    // 0 = every cell is fillType
+        uint64_t markersOffset;
+        uint32_t markerCount;
+        uint32_t fillType;
+    };
+
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+    std::vector<unsigned char> fallbackData;  // Platforms without mmap read the file instead
+
+    const Header* header() const { return reinterpret_cast<const Header*>(data); }
+    const TileEntry* findTile(int chunkX, int chunkY) const;
+    void close();
+};
@@ -45,7 +45,7 @@ void MagicMissile::fire(World& world, float x, float y, float angle, int damage)
     }
 }
 
-void MagicMissile::update(float deltaTime, World& world, std::vector<LittlePurpleJumper>& enemies) {
+void MagicMissile::update(float deltaTime, World& world, const EnemyGrid& enemies) {
     for (auto& bullet : bullets) {
         if (!bullet.active) continue;
 
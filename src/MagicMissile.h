@@ -10,7 +10,7 @@ public:
     ~MagicMissile() override = default;
 
     void fire(World& world, float x, float y, float angle, int damage) override;
-    void update(float deltaTime, World& world, std::vector<LittlePurpleJumper>& enemies) override;
+    void update(float deltaTime, World& world, const EnemyGrid& enemies) override;
     void render(SDL_Renderer* renderer, std::vector<Uint32>& pixels, int viewportWidth, int viewportHeight, float cameraX, float cameraY, float scaleX, float scaleY) override;
 
     void cleanup() override;
@@ -0,0 +1,166 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler()
+    : epoch(std::chrono::steady_clock::now())
+    , history(FRAME_HISTORY * MAX_SECTIONS, 0)
+    , frameMicros(FRAME_HISTORY, 0)
+    , events(EVENT_CAPACITY)
+{
+    for (auto& value : current) value.store(0, std::memory_order_relaxed);
+}
+
+int Profiler::section(const char* name, Kind kind) {
+    std::lock_guard<std::mutex> lock(sectionMutex);
+    int count = sectionCount.load(std::memory_order_relaxed);
+    for (int i = 0; i < count; ++i) {
+        if (names[i] == name) return i;
+    }
+    if (count == MAX_SECTIONS) {
+        std::cerr << "Profiler: too many sections, ignoring " << name << std::endl;
+        return -1;
+    }
+
+    names[count] = name;
+    kinds[count] = kind;
+    sectionCount.store(count + 1, std::memory_order_release);
+    return count;
+}
+
+void Profiler::addTime(int id, uint64_t startMicros, uint64_t durationMicros) {
+    if (id < 0) return;
+    current[id].fetch_add((int64_t)durationMicros, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(eventMutex);
+    events[eventCount % EVENT_CAPACITY] = {id, threadIndex(), startMicros, durationMicros};
+    eventCount++;
+}
+
+void Profiler::addCount(int id, int64_t value) {
+    if (id < 0) return;
+    current[id].fetch_add(value, std::memory_order_relaxed);
+}
+
+uint64_t Profiler::nowMicros() const {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Profiler::endFrame() {
+    uint64_t now = nowMicros();
+    int slot = (int)(framesRecorded % FRAME_HISTORY);
+    int64_t* row = &history[slot * MAX_SECTIONS];
+    for (int i = 0; i < MAX_SECTIONS; ++i) {
+        row[i] = current[i].exchange(0, std::memory_order_relaxed);
+    }
+    frameMicros[slot] = framesRecorded == 0 ? 0 : now - frameStart;
+    frameStart = now;
+    framesRecorded++;
+}
+
+int Profiler::recordedFrames() const {
+    return (int)std::min<uint64_t>(framesRecorded, FRAME_HISTORY);
+}
+
+int Profiler::frameSlot(int age) const {
+    return (int)((framesRecorded - 1 - age) % FRAME_HISTORY);
+}
+
+std::vector<Profiler::SectionSummary> Profiler::summarise() const {
+    std::vector<SectionSummary> summaries;
+    int frames = recordedFrames();
+    int count = sectionCount.load(std::memory_order_acquire);
+
+    for (int i = 0; i < count; ++i) {
+        double scale = kinds[i] == Kind::TIMER ? 0.001 : 1.0;
+        SectionSummary summary = {names[i], kinds[i], 0.0, 0.0, 0.0};
+        for (int age = 0; age < frames; ++age) {
+            double value = history[frameSlot(age) * MAX_SECTIONS + i] * scale;
+            summary.average += value;
+            summary.maximum = std::max(summary.maximum, value);
+            if (age == 0) summary.last = value;
+        }
+        if (frames > 0) summary.average /= frames;
+        summaries.push_back(summary);
+    }
+    return summaries;
+}
+
+double Profiler::averageFrameMillis() const {
+    // The first frame ever recorded has no start, so it does not count
+    int frames = std::min<int>(recordedFrames(), (int)framesRecorded - 1);
+    if (frames <= 0) return 0.0;
+
+    double total = 0.0;
+    for (int age = 0; age < frames; ++age) total += frameMicros[frameSlot(age)];
+    return total / frames * 0.001;
+}
+
+double Profiler::maximumFrameMillis() const {
+    uint64_t maximum = 0;
+    for (int age = 0; age < recordedFrames(); ++age) maximum = std::max(maximum, frameMicros[frameSlot(age)]);
+    return maximum * 0.001;
+}
+
+bool Profiler::writeCsv(const std::string& path) const {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+        std::cerr << "Failed to write profile: " << path << std::endl;
+        return false;
+    }
+
+    int count = sectionCount.load(std::memory_order_acquire);
+    file << "frame,frame_ms";
+    for (int i = 0; i < count; ++i) {
+        file << ",\"" << names[i] << (kinds[i] == Kind::TIMER ? " (ms)" : "") << "\"";
+    }
+    file << "\n";
+
+    int frames = recordedFrames();
+    for (int age = frames - 1; age >= 0; --age) {
+        int slot = frameSlot(age);
+        file << framesRecorded - 1 - age << "," << frameMicros[slot] * 0.001;
+        for (int i = 0; i < count; ++i) {
+            int64_t value = history[slot * MAX_SECTIONS + i];
+            if (kinds[i] == Kind::TIMER) file << "," << value * 0.001;
+            else file << "," << value;
+        }
+        file << "\n";
+    }
+    return true;
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) const {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+        std::cerr << "Failed to write profile: " << path << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(eventMutex);
+    uint64_t first = eventCount > (uint64_t)EVENT_CAPACITY ? eventCount - EVENT_CAPACITY : 0;
+
+    // Complete ("X") events: name, start and duration in microseconds, one track per thread
+    file << "{\"traceEvents\":[";
+    for (uint64_t i = first; i < eventCount; ++i) {
+        const Event& event = events[i % EVENT_CAPACITY];
+        if (i != first) file << ",";
+        file << "\n{\"name\":\"" << names[event.section] << "\",\"cat\":\"frame\",\"ph\":\"X\""
+             << ",\"ts\":" << event.start << ",\"dur\":" << event.duration
+             << ",\"pid\":1,\"tid\":" << event.thread << "}";
+    }
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return true;
+}
+
+int Profiler::threadIndex() {
+    static std::atomic<int> nextIndex{0};
+    thread_local int index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Frame profiler: named scoped timers and counters, kept for the last FRAME_HISTORY frames.
+//
+// PROFILE_SCOPE("name") times the rest of the enclosing block, PROFILE_COUNT("name", n) adds n
+// to a counter and PROFILE_END_FRAME() closes the frame (main loop). Scopes and counters work
+// from any thread, the simulation thread and OpenMP workers included; a sample counts towards
+// the frame that is open when it finishes. Every timed scope is also kept in a ring buffer of
+// events for Chrome trace output.
+//
+// Without SAND_PROFILING (CMake option) the macros compile to nothing.
+class Profiler {
+public:
+    static constexpr int MAX_SECTIONS = 64;
+    static constexpr int FRAME_HISTORY = 240;
+    static constexpr int EVENT_CAPACITY = 1 << 16;
+
+    enum class Kind { TIMER, COUNTER };
+
+    struct SectionSummary {
+        std::string name;
+        Kind kind;
+        double average;  // Per frame over the history: milliseconds for timers
+        double maximum;
+        double last;     // Last closed frame
+    };
+
+    static Profiler& instance();
+
+    // Id for a section name, registered on first use (-1 once MAX_SECTIONS are in use)
+    int section(const char* name, Kind kind);
+
+    void addTime(int id, uint64_t startMicros, uint64_t durationMicros);
+    void addCount(int id, int64_t value);
+    uint64_t nowMicros() const;
+
+    // Close the current frame (main thread)
+    void endFrame();
+
+    // Reading the history (main thread)
+    std::vector<SectionSummary> summarise() const;
+    double averageFrameMillis() const;
+    double maximumFrameMillis() const;
+
+    // One row per recorded frame, one column per section
+    bool writeCsv(const std::string& path) const;
+    // Recent timed scopes, for chrome://tracing or ui.perfetto.dev
+    bool writeChromeTrace(const std::string& path) const;
+
+private:
+    struct Event {
+        int section;
+        int thread;
+        uint64_t start, duration;  // Microseconds since the profiler started
+    };
+
+    Profiler();
+
+    std::chrono::steady_clock::time_point epoch;
+
+    mutable std::mutex sectionMutex;
+    std::string names[MAX_SECTIONS];
+    Kind kinds[MAX_SECTIONS];
+    std::atomic<int> sectionCount{0};
+
+    // Open frame, then a ring of closed frames (FRAME_HISTORY x MAX_SECTIONS values)
+    std::atomic<int64_t> current[MAX_SECTIONS];
+    std::vector<int64_t> history;
+    std::vector<uint64_t> frameMicros;
+    uint64_t framesRecorded = 0;
+    uint64_t frameStart = 0;
+
+    mutable std::mutex eventMutex;
+    std::vector<Event> events;
+    uint64_t eventCount = 0;
+
+    int recordedFrames() const;
+    int frameSlot(int age) const;  // Ring index of the frame `age` frames before the last one
+    static int threadIndex();
+};
+
+// Times its lifetime into a profiler section
+class ProfileScope {
+public:
+    explicit ProfileScope(int id) : id(id), start(Profiler::instance().nowMicros()) {}
+    ~ProfileScope() {
+        Profiler& profiler = Profiler::instance();
+        profiler.addTime(id, start, profiler.nowMicros() - start);
+    }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    int id;
+    uint64_t start;
+};
+
+#ifdef SAND_PROFILING
+#define PROFILE_JOIN_INNER(a, b) a##b
+#define PROFILE_JOIN(a, b) PROFILE_JOIN_INNER(a, b)
+#define PROFILE_SCOPE(name) \
+    static const int PROFILE_JOIN(profileSection, __LINE__) = Profiler::instance().section(name, Profiler::Kind::TIMER); \
+    ProfileScope PROFILE_JOIN(profileScope, __LINE__)(PROFILE_JOIN(profileSection, __LINE__))
+#define PROFILE_COUNT(name, value) \
+    do { \
+        static const int profileSection = Profiler::instance().section(name, Profiler::Kind::COUNTER); \
+        Profiler::instance().addCount(profileSection, (value)); \
+    } while (0)
+#define PROFILE_END_FRAME() Profiler::instance().endFrame()
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_COUNT(name, value) ((void)0)
+#define PROFILE_END_FRAME() ((void)0)
+#endif
@@ -0,0 +1,9 @@
+#include "Random.h"
+#include <chrono>
+#include <functional>
+#include <thread>
+
+uint64_t Random::threadSeed() {
+    uint64_t clock = (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+    return clock ^ std::hash<std::thread::id>()(std::this_thread::get_id());
+}
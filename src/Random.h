@@ -0,0 +1,92 @@
+#pragma once
+#include <cstdint>
+
+// Fast random numbers for the simulation (xoshiro128**).
+//
+// Every thread has its own generator (Random::local()), so particle rules running in
+// parallel tiles never share state. Code that must be reproducible reseeds the thread's
+// generator from a position hash before it starts: World does this per simulation tile and
+// tick, and per chunk before generating it, so results do not depend on which thread ran
+// the work. Random::hash() is also usable on its own as a stateless per-cell random value.
+class Random {
+public:
+    explicit Random(uint64_t seed = 1) { reseed(seed); }
+
+    void reseed(uint64_t seed) {
+        // splitmix64 spreads any seed (including 0) over the whole state
+        for (uint32_t& word : state) {
+            seed += 0x9e3779b97f4a7c15ull;
+            word = (uint32_t)(mix64(seed) >> 32);
+        }
+        bitBuffer = 0;
+        bitsLeft = 0;
+    }
+
+    uint32_t next() {
+        uint32_t result = rotl(state[1] * 5, 7) * 9;
+        uint32_t t = state[1] << 9;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 11);
+        return result;
+    }
+
+    // Uniform integer in [0, n)
+    uint32_t below(uint32_t n) { return (uint32_t)(((uint64_t)next() * n) >> 32); }
+
+    // Uniform integer in [lo, hi]
+    int range(int lo, int hi) { return lo + (int)below((uint32_t)(hi - lo + 1)); }
+
+    // Uniform float in [0, 1)
+    float uniform() { return (next() >> 8) * (1.0f / 16777216.0f); }
+
+    bool chance(float probability) { return uniform() < probability; }
+
+    // Fair coin flip; 32 flips per generator step
+    bool coin() {
+        if (bitsLeft == 0) {
+            bitBuffer = next();
+            bitsLeft = 32;
+        }
+        bool bit = bitBuffer & 1;
+        bitBuffer >>= 1;
+        bitsLeft--;
+        return bit;
+    }
+
+    // Generator of the calling thread
+    static Random& local() {
+        thread_local Random generator(threadSeed());
+        return generator;
+    }
+
+    // Stateless random value for a position: the same inputs always give the same result
+    static uint64_t hash(uint64_t seed, int x, int y, uint64_t salt = 0) {
+        uint64_t h = mix64(seed ^ 0x243f6a8885a308d3ull);
+        h = mix64(h ^ (uint32_t)x);
+        h = mix64(h ^ ((uint64_t)(uint32_t)y << 32) ^ salt);
+        return h;
+    }
+
+    // Uniform float in [0, 1) for a position
+    static float hashUniform(uint64_t seed, int x, int y, uint64_t salt = 0) {
+        return (hash(seed, x, y, salt) >> 40) * (1.0f / 16777216.0f);
+    }
+
+private:
+    uint32_t state[4];
+    uint32_t bitBuffer;
+    int bitsLeft;
+
+    static uint64_t threadSeed();  // Clock and thread id: distinct streams until reseeded
+    static uint32_t rotl(uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+
+    static uint64_t mix64(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+};
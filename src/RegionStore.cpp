@@ -0,0 +1,323 @@
+#include "RegionStore.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+// Size of the offset table at the start of every region file
+static constexpr uint64_t REGION_HEADER_BYTES = RegionStore::CHUNKS_PER_REGION * (sizeof(uint64_t) + sizeof(uint32_t));
+
+// Regions smaller than this are never compacted
+static constexpr uint64_t MIN_COMPACT_BYTES = 4 * 1024 * 1024;
+
+RegionStore::RegionStore(const std::string& dir) : directory(dir) {
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+    if (ec) {
+        std::cerr << "Failed to create region cache directory " << directory << ": " << ec.message() << std::endl;
+        return;
+    }
+
+    // Region files from an earlier session describe a world that no longer exists
+    for (const auto& entry : fs::directory_iterator(directory, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind("region_", 0) == 0 && entry.path().extension() == ".bin") {
+            fs::remove(entry.path(), ec);
+        }
+    }
+
+    open = true;
+    writerThread = std::thread(&RegionStore::writerLoop, this);
+}
+
+RegionStore::~RegionStore() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+        writeQueue.clear();
+        pending.clear();
+    }
+    queueChanged.notify_all();
+
+    if (writerThread.joinable()) {
+        writerThread.join();
+    }
+}
+
+std::string RegionStore::regionPath(int chunkX, int chunkY) const {
+    return directory + "/region_" + std::to_string(chunkX / REGION_SIZE) + "_" + std::to_string(chunkY / REGION_SIZE) + ".bin";
+}
+
+void RegionStore::save(std::unique_ptr<WorldChunk> chunk) {
+    if (!chunk) return;
+    if (!open) return;  // No cache: the chunk is simply dropped
+
+    int64_t key = makeKey(chunk->getChunkX(), chunk->getChunkY());
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        pending[key] = std::move(chunk);
+        writeQueue.push_back(key);
+    }
+    queueChanged.notify_all();
+}
+
+bool RegionStore::contains(int chunkX, int chunkY) const {
+    int64_t key = makeKey(chunkX, chunkY);
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (pending.count(key) || writingKey == key) return true;
+    }
+
+    std::lock_guard<std::mutex> lock(fileMutex);
+    return hasRecord(chunkX, chunkY);
+}
+
+std::unique_ptr<WorldChunk> RegionStore::load(int chunkX, int chunkY) {
+    int64_t key = makeKey(chunkX, chunkY);
+    {
+        std::unique_lock<std::mutex> lock(queueMutex);
+
+        // Still queued: take it back without touching the disk
+        auto it = pending.find(key);
+        if (it != pending.end()) {
+            auto chunk = std::move(it->second);
+            pending.erase(it);
+            stats.chunksReclaimed++;
+            return chunk;
+        }
+
+        // Being written right now: wait for the record to land
+        queueChanged.wait(lock, [&] { return writingKey != key; });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<unsigned char> data;
+    std::unique_ptr<WorldChunk> chunk;
+    {
+        std::lock_guard<std::mutex> lock(fileMutex);
+        if (!readRecord(chunkX, chunkY, data)) return nullptr;
+        dropRecord(chunkX, chunkY);  // The chunk is live again; its record is now stale
+    }
+
+    chunk = WorldChunk::deserialize(data.data(), data.size());
+    if (!chunk) {
+        std::cerr << "Corrupt region record for chunk (" << chunkX << ", " << chunkY << ")" << std::endl;
+        return nullptr;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::lock_guard<std::mutex> lock(queueMutex);
+    stats.chunksRead++;
+    stats.readSeconds += seconds;
+    return chunk;
+}
+
+void RegionStore::discard(int chunkX, int chunkY) {
+    int64_t key = makeKey(chunkX, chunkY);
+    {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        pending.erase(key);
+        queueChanged.wait(lock, [&] { return writingKey != key; });
+    }
+
+    std::lock_guard<std::mutex> lock(fileMutex);
+    dropRecord(chunkX, chunkY);
+}
+
+void RegionStore::flush() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    queueChanged.wait(lock, [&] { return writeQueue.empty() && writingKey < 0; });
+}
+
+RegionStore::Stats RegionStore::getStats() const {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return stats;
+}
+
+void RegionStore::writerLoop() {
+    std::vector<unsigned char> buffer;
+
+    while (true) {
+        std::unique_ptr<WorldChunk> chunk;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueChanged.wait(lock, [&] { return stopping || !writeQueue.empty(); });
+            if (stopping) return;
+
+            int64_t key = writeQueue.front();
+            writeQueue.pop_front();
+
+            // Reclaimed or discarded since it was queued, or queued twice
+            auto it = pending.find(key);
+            if (it == pending.end()) {
+                queueChanged.notify_all();
+                continue;
+            }
+            chunk = std::move(it->second);
+            pending.erase(it);
+            writingKey = key;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        buffer.clear();
+        chunk->serialize(buffer);
+        bool written;
+        {
+            std::lock_guard<std::mutex> lock(fileMutex);
+            written = writeRecord(chunk->getChunkX(), chunk->getChunkY(), buffer);
+        }
+        if (!written) {
+            std::cerr << "Failed to write chunk (" << chunk->getChunkX() << ", " << chunk->getChunkY()
+                      << ") to " << regionPath(chunk->getChunkX(), chunk->getChunkY()) << std::endl;
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            writingKey = -1;
+            if (written) {
+                stats.chunksWritten++;
+                stats.bytesWritten += buffer.size();
+                stats.writeSeconds += seconds;
+            }
+        }
+        queueChanged.notify_all();
+    }
+}
+
+bool RegionStore::hasRecord(int chunkX, int chunkY) const {
+    auto it = regions.find(regionIndex(chunkX, chunkY));
+    return it != regions.end() && it->second.records[recordIndex(chunkX, chunkY)].size > 0;
+}
+
+bool RegionStore::writeRecord(int chunkX, int chunkY, const std::vector<unsigned char>& data) {
+    std::string path = regionPath(chunkX, chunkY);
+    Region& region = regions[regionIndex(chunkX, chunkY)];
+
+    std::fstream file;
+    if (region.fileSize == 0) {
+        // New region file: empty offset table
+        file.open(path, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+        std::vector<char> header(REGION_HEADER_BYTES, 0);
+        file.write(header.data(), header.size());
+        if (!file) return false;
+        region.fileSize = REGION_HEADER_BYTES;
+    } else {
+        file.open(path, std::ios::binary | std::ios::in | std::ios::out);
+    }
+    if (!file) return false;
+
+    ChunkRecord& record = region.records[recordIndex(chunkX, chunkY)];
+    region.liveBytes -= record.size;
+
+    // Append the record, then point the table entry at it
+    record.offset = region.fileSize;
+    record.size = (uint32_t)data.size();
+    file.seekp(record.offset);
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+    file.seekp(recordIndex(chunkX, chunkY) * (sizeof(uint64_t) + sizeof(uint32_t)));
+    file.write(reinterpret_cast<const char*>(&record.offset), sizeof(record.offset));
+    file.write(reinterpret_cast<const char*>(&record.size), sizeof(record.size));
+
+    if (!file) {
+        record = ChunkRecord{};
+        return false;
+    }
+    file.close();
+
+    region.fileSize += data.size();
+    region.liveBytes += data.size();
+
+    // The record is already on disk; a failed compaction leaves the file as it was and is
+    // retried on the region's next write
+    if (region.fileSize > MIN_COMPACT_BYTES && region.fileSize - REGION_HEADER_BYTES > 2 * region.liveBytes &&
+        !compactRegion(chunkX, chunkY, region)) {
+        std::cerr << "Failed to compact region file " << path << std::endl;
+    }
+    return true;
+}
+
+bool RegionStore::readRecord(int chunkX, int chunkY, std::vector<unsigned char>& data) {
+    auto it = regions.find(regionIndex(chunkX, chunkY));
+    if (it == regions.end()) return false;
+
+    const ChunkRecord& record = it->second.records[recordIndex(chunkX, chunkY)];
+    if (record.size == 0) return false;
+
+    std::ifstream file(regionPath(chunkX, chunkY), std::ios::binary);
+    if (!file) return false;
+
+    data.resize(record.size);
+    file.seekg(record.offset);
+    file.read(reinterpret_cast<char*>(data.data()), record.size);
+    return (bool)file;
+}
+
+void RegionStore::dropRecord(int chunkX, int chunkY) {
+    auto it = regions.find(regionIndex(chunkX, chunkY));
+    if (it == regions.end()) return;
+
+    // Only the in-memory table changes; the dead bytes are reclaimed by compaction
+    ChunkRecord& record = it->second.records[recordIndex(chunkX, chunkY)];
+    it->second.liveBytes -= record.size;
+    record = ChunkRecord{};
+}
+
+bool RegionStore::compactRegion(int chunkX, int chunkY, Region& region) {
+    std::string path = regionPath(chunkX, chunkY);
+    std::string tempPath = path + ".tmp";
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::error_code ec;
+        fs::remove(tempPath, ec);
+        return false;
+    }
+
+    Region compacted;
+    compacted.fileSize = REGION_HEADER_BYTES;
+
+    std::vector<char> header(REGION_HEADER_BYTES, 0);
+    out.write(header.data(), header.size());
+
+    std::vector<char> data;
+    for (int i = 0; i < CHUNKS_PER_REGION; ++i) {
+        const ChunkRecord& record = region.records[i];
+        if (record.size == 0) continue;
+
+        data.resize(record.size);
+        in.seekg(record.offset);
+        in.read(data.data(), record.size);
+        out.write(data.data(), record.size);
+
+        compacted.records[i] = {compacted.fileSize, record.size};
+        compacted.fileSize += record.size;
+        compacted.liveBytes += record.size;
+    }
+
+    out.seekp(0);
+    for (const ChunkRecord& record : compacted.records) {
+        out.write(reinterpret_cast<const char*>(&record.offset), sizeof(record.offset));
+        out.write(reinterpret_cast<const char*>(&record.size), sizeof(record.size));
+    }
+    bool copied = in && out;
+    in.close();
+    out.close();
+
+    std::error_code ec;
+    if (copied) fs::rename(tempPath, path, ec);
+    if (!copied || ec) {
+        fs::remove(tempPath, ec);
+        return false;
+    }
+
+    region = compacted;
+    return true;
+}
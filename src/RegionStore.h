@@ -0,0 +1,101 @@
+#pragma once
+#include "WorldChunk.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Disk cache for chunks evicted from memory.
+//
+// Chunks are grouped into region files of REGION_SIZE x REGION_SIZE chunks. A region file
+// starts with an offset table and chunk records are appended behind it; a file rewrites
+// itself once more than half of it is dead records. Saves are written by a background
+// thread, and a chunk still waiting in the queue is handed straight back by load().
+//
+// The store is a per-session cache: region files from earlier runs are removed on open
+// and queued writes are dropped on destruction.
+class RegionStore {
+public:
+    static constexpr int REGION_SIZE = 8;
+    static constexpr int CHUNKS_PER_REGION = REGION_SIZE * REGION_SIZE;
+
+    struct Stats {
+        int chunksWritten = 0;
+        int chunksRead = 0;
+        int chunksReclaimed = 0;   // Loaded back before they reached the disk
+        size_t bytesWritten = 0;
+        double writeSeconds = 0.0; // Serialize + write, on the writer thread
+        double readSeconds = 0.0;  // Read + deserialize
+    };
+
+    explicit RegionStore(const std::string& directory);
+    ~RegionStore();
+
+    bool isOpen() const { return open; }
+
+    // Queue a chunk for writing; the store takes ownership
+    void save(std::unique_ptr<WorldChunk> chunk);
+
+    // Whether a chunk has been saved (queued or on disk)
+    bool contains(int chunkX, int chunkY) const;
+
+    // Take a saved chunk back. Returns nullptr if it was never saved or cannot be read.
+    std::unique_ptr<WorldChunk> load(int chunkX, int chunkY);
+
+    // Forget any saved copy of a chunk
+    void discard(int chunkX, int chunkY);
+
+    // Block until every queued chunk is on disk
+    void flush();
+
+    Stats getStats() const;
+
+private:
+    struct ChunkRecord {
+        uint64_t offset = 0;
+        uint32_t size = 0;  // 0 = no record
+    };
+
+    struct Region {
+        ChunkRecord records[CHUNKS_PER_REGION];
+        uint64_t fileSize = 0;
+        uint64_t liveBytes = 0;
+    };
+
+    std::string directory;
+    bool open = false;
+
+    // Write queue, guarded by queueMutex
+    mutable std::mutex queueMutex;
+    std::condition_variable queueChanged;
+    std::unordered_map<int64_t, std::unique_ptr<WorldChunk>> pending;
+    std::deque<int64_t> writeQueue;
+    int64_t writingKey = -1;  // Chunk the writer thread currently holds
+    bool stopping = false;
+    Stats stats;
+
+    // Region files and their in-memory offset tables, guarded by fileMutex
+    mutable std::mutex fileMutex;
+    std::unordered_map<int, Region> regions;
+
+    std::thread writerThread;
+
+    static int64_t makeKey(int chunkX, int chunkY) { return ((int64_t)chunkY << 32) | (uint32_t)chunkX; }
+    static int regionIndex(int chunkX, int chunkY) { return (chunkY / REGION_SIZE) * 4096 + chunkX / REGION_SIZE; }
+    static int recordIndex(int chunkX, int chunkY) { return (chunkY % REGION_SIZE) * REGION_SIZE + chunkX % REGION_SIZE; }
+    std::string regionPath(int chunkX, int chunkY) const;
+
+    void writerLoop();
+
+    // Must be called with fileMutex held
+    bool hasRecord(int chunkX, int chunkY) const;
+    bool writeRecord(int chunkX, int chunkY, const std::vector<unsigned char>& data);
+    bool readRecord(int chunkX, int chunkY, std::vector<unsigned char>& data);
+    void dropRecord(int chunkX, int chunkY);
+    bool compactRegion(int chunkX, int chunkY, Region& region);
+};
@@ -1,4 +1,5 @@
 #include "SandSimulator.h"
+#include "Random.h"
 #include <cstdlib>
 #include <ctime>
 #include <cmath>
@@ -20,7 +21,6 @@ SandSimulator::SandSimulator(const Config& cfg) : config(cfg), debugFrameCount(0
     isSettled.resize(width * height, false);    // Start unsettled (velocity physics)
     attachmentGroup.resize(width * height, 0);
     particleAge.resize(width * height, 0);      // All particles start at age 0
-    std::srand(std::time(nullptr));
 
     // Initialize activity tracking (performance optimization)
     chunkWidth = 16;
@@ -36,7 +36,7 @@ SandSimulator::SandSimulator(const Config& cfg) : config(cfg), debugFrameCount(0
     debugFile.close();
 
     // Initialize particle count cache
-    for (int i = 0; i < 10; ++i) {
+    for (int i = 0; i < PARTICLE_TYPE_COUNT; ++i) {
         particleCounts[i] = 0;
     }
 }
@@ -473,7 +473,7 @@ ParticleColor SandSimulator::generateRandomColor(int baseR, int baseG, int baseB
         HSL hsl = rgbToHsl(baseR, baseG, baseB);
 
         // Generate a random scalar between -1.0 and 1.0
-        double random_scalar = ((double)std::rand() / RAND_MAX) * 2.0 - 1.0;
+        double random_scalar = Random::local().uniform() * 2.0 - 1.0;
 
         // Apply variation to lightness
         // The variation parameter is an integer, let's scale it to be a factor for lightness
@@ -630,7 +630,7 @@ void SandSimulator::spawnRockCluster(int centerX, int centerY) {
     if (!inBounds(centerX, centerY)) return;
 
     int groupId = nextAttachmentGroupId++;
-    int radius = 2 + (std::rand() % 2); // Random radius 2-3
+    int radius = Random::local().range(2, 3); // Random radius 2-3
 
     // Track positions for cache
     std::vector<std::pair<int, int>> groupPositions;
@@ -663,7 +663,7 @@ void SandSimulator::spawnWoodCluster(int centerX, int centerY) {
     if (!inBounds(centerX, centerY)) return;
 
     int groupId = nextAttachmentGroupId++;
-    int radius = 2 + (std::rand() % 2); // Random radius 2-3
+    int radius = Random::local().range(2, 3); // Random radius 2-3
 
     // Track positions for cache
     std::vector<std::pair<int, int>> groupPositions;
@@ -722,7 +722,7 @@ void SandSimulator::spawnParticles() {
 
     int spawnX = baseX;
     if (spawnConfig->spawnPositionRandomness > 0) {
-        int offset = (std::rand() % (spawnConfig->spawnPositionRandomness * 2 + 1)) - spawnConfig->spawnPositionRandomness;
+        int offset = Random::local().range(-spawnConfig->spawnPositionRandomness, spawnConfig->spawnPositionRandomness);
         spawnX = clamp(baseX + offset, 0, width - 1);
     }
 
@@ -753,7 +753,7 @@ void SandSimulator::updateSandParticle(int x, int y) {
     bool rightDisplace = (x + 1 < width && y + 1 < height && canDisplace(myType, getParticleType(x + 1, y + 1)));
 
     if (leftOpen && rightOpen) {
-        float random = static_cast<float>(std::rand()) / RAND_MAX;
+        float random = Random::local().uniform();
         int newX = (random < config.sand.diagonalFallChance) ? x - 1 : x + 1;
         moveParticle(x, y, newX, y + 1);
         return;
@@ -764,7 +764,7 @@ void SandSimulator::updateSandParticle(int x, int y) {
         moveParticle(x, y, x + 1, y + 1);
         return;
     } else if (leftDisplace && rightDisplace) {
-        float random = static_cast<float>(std::rand()) / RAND_MAX;
+        float random = Random::local().uniform();
         int newX = (random < config.sand.diagonalFallChance) ? x - 1 : x + 1;
         // Swap with lighter particle
         swapParticles(x, y, newX, y + 1);
@@ -877,7 +877,7 @@ bool SandSimulator::trySandRandomTumble(int x, int y) {
     float chance = config.sand.randomTumbleChance;
     if (chance <= 0.0f) return false;
 
-    float random = static_cast<float>(std::rand()) / RAND_MAX;
+    float random = Random::local().uniform();
     if (random > chance) return false;
 
     // Try tumbling left or right
@@ -885,7 +885,7 @@ bool SandSimulator::trySandRandomTumble(int x, int y) {
     bool rightClear = !isOccupied(x + 1, y);
 
     if (leftClear && rightClear) {
-        int dir = (std::rand() % 2) ? -1 : 1;
+        int dir = Random::local().coin() ? -1 : 1;
         moveParticle(x, y, x + dir, y);
         return true;
     } else if (leftClear) {
@@ -922,8 +922,7 @@ void SandSimulator::updateWaterParticle(int x, int y) {
     bool rightDisplace = (x + 1 < width && y + 1 < height && canDisplace(myType, getParticleType(x + 1, y + 1)));
 
     if (leftDiagOpen && rightDiagOpen) {
-        float random = static_cast<float>(std::rand()) / RAND_MAX;
-        int newX = (random < 0.5f) ? x - 1 : x + 1;
+        int newX = Random::local().coin() ? x - 1 : x + 1;
         moveParticle(x, y, newX, y + 1);
         return;
     } else if (leftDiagOpen) {
@@ -933,8 +932,7 @@ void SandSimulator::updateWaterParticle(int x, int y) {
         moveParticle(x, y, x + 1, y + 1);
         return;
     } else if (leftDisplace && rightDisplace) {
-        float random = static_cast<float>(std::rand()) / RAND_MAX;
-        int newX = (random < 0.5f) ? x - 1 : x + 1;
+        int newX = Random::local().coin() ? x - 1 : x + 1;
         // Swap with lighter particle
         swapParticles(x, y, newX, y + 1);
         return;
@@ -956,7 +954,7 @@ void SandSimulator::updateWaterParticle(int x, int y) {
             bool rightOpen = (x + speed < width) && !isOccupied(x + speed, y);
 
             if (leftOpen && rightOpen) {
-                float random = static_cast<float>(std::rand()) / RAND_MAX;
+                float random = Random::local().uniform();
                 int newX = (random < config.water.waterDispersionChance) ? x - speed : x + speed;
                 moveParticle(x, y, newX, y);
                 return;
@@ -1170,7 +1168,7 @@ void SandSimulator::updateLavaParticle(int x, int y) {
     bool rightDisplace = (x + 1 < width && y + 1 < height && canDisplace(myType, getParticleType(x + 1, y + 1)));
 
     if (leftOpen && rightOpen) {
-        float random = static_cast<float>(std::rand()) / RAND_MAX;
+        float random = Random::local().uniform();
         int newX = (random < config.lava.diagonalFallChance) ? x - 1 : x + 1;
         moveParticle(x, y, newX, y + 1);
         return;
@@ -1195,7 +1193,7 @@ void SandSimulator::updateLavaParticle(int x, int y) {
             bool rightFree = (x + i < width && !isOccupied(x + i, y));
 
             if (leftFree && rightFree) {
-                float random = static_cast<float>(std::rand()) / RAND_MAX;
+                float random = Random::local().uniform();
                 int newX = (random < config.lava.waterDispersionChance) ? x - i : x + i;
                 moveParticle(x, y, newX, y);
                 return;
@@ -1231,8 +1229,7 @@ void SandSimulator::updateSteamParticle(int x, int y) {
     bool rightOpen = (x + 1 < width && y - 1 >= 0 && !isOccupied(x + 1, y - 1));
 
     if (leftOpen && rightOpen) {
-        float random = static_cast<float>(std::rand()) / RAND_MAX;
-        int newX = (random < 0.5f) ? x - 1 : x + 1;
+        int newX = Random::local().coin() ? x - 1 : x + 1;
         moveParticle(x, y, newX, y - 1);
         return;
     } else if (leftOpen) {
@@ -1250,7 +1247,7 @@ void SandSimulator::updateSteamParticle(int x, int y) {
             bool rightFree = (x + i < width && !isOccupied(x + i, y));
 
             if (leftFree && rightFree) {
-                float random = static_cast<float>(std::rand()) / RAND_MAX;
+                float random = Random::local().uniform();
                 int newX = (random < config.steam.waterDispersionChance) ? x - i : x + i;
                 moveParticle(x, y, newX, y);
                 return;
@@ -1284,7 +1281,7 @@ void SandSimulator::updateObsidianParticle(int x, int y) {
 
 void SandSimulator::updateFireParticle(int x, int y) {
     // Fire burns out over time (random chance)
-    float random = static_cast<float>(std::rand()) / RAND_MAX;
+    float random = Random::local().uniform();
     if (random < config.fire.randomTumbleChance) {
         // Burn out - convert to empty or steam
         if (random < config.fire.randomTumbleChance * 0.3f) {
@@ -1319,8 +1316,7 @@ void SandSimulator::updateFireParticle(int x, int y) {
     bool rightOpen = (x + 1 < width && y - 1 >= 0 && !isOccupied(x + 1, y - 1));
 
     if (leftOpen && rightOpen) {
-        float rand = static_cast<float>(std::rand()) / RAND_MAX;
-        int newX = (rand < 0.5f) ? x - 1 : x + 1;
+        int newX = Random::local().coin() ? x - 1 : x + 1;
         moveParticle(x, y, newX, y - 1);
         return;
     } else if (leftOpen) {
@@ -1338,7 +1334,7 @@ void SandSimulator::updateFireParticle(int x, int y) {
             bool rightFree = (x + i < width && !isOccupied(x + i, y));
 
             if (leftFree && rightFree) {
-                float rand = static_cast<float>(std::rand()) / RAND_MAX;
+                float rand = Random::local().uniform();
                 int newX = (rand < config.fire.waterDispersionChance) ? x - i : x + i;
                 moveParticle(x, y, newX, y);
                 return;
@@ -1427,7 +1423,7 @@ void SandSimulator::updateParticleSpacing(int x, int y) {
         if (!inBounds(neighborX, neighborY)) continue;
 
         // Roll random chance for this direction
-        float random = static_cast<float>(std::rand()) / RAND_MAX;
+        float random = Random::local().uniform();
         if (random >= expansionChance) continue;
 
         // Check if there's a particle at neighbor position
@@ -2024,8 +2020,7 @@ bool SandSimulator::tryMoveWithVelocity(int x, int y, float vx, float vy) {
             // Only add horizontal velocity if we don't already have significant horizontal movement
             if (std::abs(velocities[y * width + x].vx) < typeConfig.diagonalSlideThreshold) {
                 if (leftOpen && rightOpen) {
-                    float random = static_cast<float>(std::rand()) / RAND_MAX;
-                    velocities[y * width + x].vx = (random < 0.5f) ? -typeConfig.diagonalSlideVelocity : typeConfig.diagonalSlideVelocity;
+                    velocities[y * width + x].vx = Random::local().coin() ? -typeConfig.diagonalSlideVelocity : typeConfig.diagonalSlideVelocity;
                     if (shouldLog) {
                         logDebug("    -> RESTING, added diagonal velocity (both open)");
                     }
@@ -2116,8 +2111,7 @@ bool SandSimulator::tryMoveWithVelocity(int x, int y, float vx, float vy) {
         if (std::abs(velocities[y * width + x].vx) < typeConfig.diagonalSlideThreshold) {
             if (leftOpen && rightOpen) {
                 // Both diagonals open - add random horizontal velocity
-                float random = static_cast<float>(std::rand()) / RAND_MAX;
-                velocities[y * width + x].vx = (random < 0.5f) ? -typeConfig.diagonalSlideVelocity : typeConfig.diagonalSlideVelocity;
+                velocities[y * width + x].vx = Random::local().coin() ? -typeConfig.diagonalSlideVelocity : typeConfig.diagonalSlideVelocity;
                 velocities[y * width + x].vy *= 0.5f; // Reduce vertical velocity
                 if (shouldLog) {
                     logDebug("    -> BLOCKED, added diagonal velocity");
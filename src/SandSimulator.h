@@ -20,6 +20,8 @@ enum class ParticleType : unsigned char {
     MOSS = 11
 };
 
+constexpr int PARTICLE_TYPE_COUNT = 12;
+
 struct ParticleColor {
     unsigned char r, g, b;
 };
@@ -96,7 +98,7 @@ private:
     ParticleType currentSpawnType;
 
     // Cached particle counts (for performance)
-    mutable int particleCounts[10];  // Index matches ParticleType enum values
+    mutable int particleCounts[PARTICLE_TYPE_COUNT];  // Index matches ParticleType enum values
     void incrementParticleCount(ParticleType type);
     void decrementParticleCount(ParticleType type);
 
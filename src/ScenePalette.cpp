@@ -0,0 +1,157 @@
+#include "ScenePalette.h"
+#include <algorithm>
+
+// Colours the scene image uses for each particle type
+struct SceneColorMapping {
+    int r, g, b;
+    ParticleType type;
+};
+
+static const SceneColorMapping SCENE_COLOR_MAP[] = {
+    // Sand variants
+    {255, 200, 100, ParticleType::SAND},
+    {194, 178, 128, ParticleType::SAND},  // Tan sand
+
+    // Water variants - multiple blues
+    {50, 100, 255, ParticleType::WATER},
+    {0, 0, 255, ParticleType::WATER},      // Pure blue
+    {0, 100, 255, ParticleType::WATER},    // Azure
+    {50, 150, 255, ParticleType::WATER},   // Light blue
+    {64, 164, 223, ParticleType::WATER},   // Sky blue
+
+    // Rock
+    {128, 128, 128, ParticleType::ROCK},
+    {100, 100, 100, ParticleType::ROCK},   // Darker gray
+    {150, 150, 150, ParticleType::ROCK},   // Lighter gray
+
+    // Lava
+    {255, 100, 0, ParticleType::LAVA},
+    {255, 69, 0, ParticleType::LAVA},      // Orange-red
+
+    // Steam
+    {240, 240, 240, ParticleType::STEAM},
+    {255, 255, 255, ParticleType::STEAM},  // Pure white
+
+    // Obsidian
+    {30, 20, 40, ParticleType::OBSIDIAN},
+
+    // Fire
+    {255, 50, 0, ParticleType::FIRE},
+    {255, 0, 0, ParticleType::FIRE},       // Pure red
+
+    // Ice
+    {200, 230, 255, ParticleType::ICE},
+
+    // Glass
+    {100, 180, 180, ParticleType::GLASS},
+    {0, 255, 255, ParticleType::GLASS},    // Cyan
+
+    // Wood
+    {139, 90, 43, ParticleType::WOOD},
+    {139, 69, 19, ParticleType::WOOD},      // Saddle brown
+
+    // Moss
+    {0, 150, 0, ParticleType::MOSS},
+    {20, 130, 20, ParticleType::MOSS}
+};
+
+// #450981 = RGB(69, 9, 129) - Little Purple Jumper
+static constexpr int JUMPER_R = 69, JUMPER_G = 9, JUMPER_B = 129;
+static constexpr int JUMPER_THRESHOLD = 500;  // Tight threshold for exact marker match
+
+static int colorDistance(int r1, int g1, int b1, int r2, int g2, int b2) {
+    return (r1 - r2) * (r1 - r2) + (g1 - g2) * (g1 - g2) + (b1 - b2) * (b1 - b2);
+}
+
+// Smallest and largest squared distance from c to any value in [lo, hi]
+static int axisMinDistance(int lo, int hi, int c) {
+    if (c < lo) return (lo - c) * (lo - c);
+    if (c > hi) return (c - hi) * (c - hi);
+    return 0;
+}
+
+static int axisMaxDistance(int lo, int hi, int c) {
+    return std::max((c - lo) * (c - lo), (c - hi) * (c - hi));
+}
+
+ScenePalette::ScenePalette(int darkCutoff, int matchThreshold)
+    : darkCutoff(darkCutoff)
+    , matchThreshold(matchThreshold)
+    , table(1 << (3 * BUCKET_BITS))
+{
+    const int step = 1 << (8 - BUCKET_BITS);
+    for (int r = 0; r < 256; r += step) {
+        for (int g = 0; g < 256; g += step) {
+            for (int b = 0; b < 256; b += step) {
+                table[bucketIndex(r, g, b)] = classifyBucket(r, g, b);
+            }
+        }
+    }
+}
+
+unsigned char ScenePalette::classifyExact(int r, int g, int b) const {
+    // Check for enemy spawn markers FIRST (before particle matching)
+    if (colorDistance(r, g, b, JUMPER_R, JUMPER_G, JUMPER_B) < JUMPER_THRESHOLD) return JUMPER_MARKER;
+
+    // Skip dark pixels (empty/background)
+    if (r < darkCutoff && g < darkCutoff && b < darkCutoff) return (unsigned char)ParticleType::EMPTY;
+
+    // Threshold for color matching - reject blended/anti-aliased pixels
+    ParticleType bestMatch = ParticleType::EMPTY;
+    int bestDist = matchThreshold;
+
+    for (const auto& cm : SCENE_COLOR_MAP) {
+        int dist = colorDistance(r, g, b, cm.r, cm.g, cm.b);
+        if (dist < bestDist) {
+            bestDist = dist;
+            bestMatch = cm.type;
+        }
+    }
+    return (unsigned char)bestMatch;
+}
+
+// Result shared by every colour of the bucket starting at (r0, g0, b0), or AMBIGUOUS
+unsigned char ScenePalette::classifyBucket(int r0, int g0, int b0) const {
+    const int last = (1 << (8 - BUCKET_BITS)) - 1;
+    int r1 = r0 + last, g1 = g0 + last, b1 = b0 + last;
+
+    auto minDistance = [&](int r, int g, int b) {
+        return axisMinDistance(r0, r1, r) + axisMinDistance(g0, g1, g) + axisMinDistance(b0, b1, b);
+    };
+    auto maxDistance = [&](int r, int g, int b) {
+        return axisMaxDistance(r0, r1, r) + axisMaxDistance(g0, g1, g) + axisMaxDistance(b0, b1, b);
+    };
+
+    if (maxDistance(JUMPER_R, JUMPER_G, JUMPER_B) < JUMPER_THRESHOLD) return JUMPER_MARKER;
+    if (minDistance(JUMPER_R, JUMPER_G, JUMPER_B) < JUMPER_THRESHOLD) return AMBIGUOUS;
+
+    if (r1 < darkCutoff && g1 < darkCutoff && b1 < darkCutoff) return (unsigned char)ParticleType::EMPTY;
+    bool partlyDark = r0 < darkCutoff && g0 < darkCutoff && b0 < darkCutoff;
+
+    // The colour every pixel of the bucket is within the threshold of, if any
+    ParticleType bestType = ParticleType::EMPTY;
+    int bestMax = matchThreshold;
+    for (const auto& cm : SCENE_COLOR_MAP) {
+        int dist = maxDistance(cm.r, cm.g, cm.b);
+        if (dist < bestMax) {
+            bestMax = dist;
+            bestType = cm.type;
+        }
+    }
+
+    // Any colour of another type that some pixel could be as close to makes the bucket ambiguous.
+    // Without a covering colour, the bucket is only safe if no colour can match at all.
+    for (const auto& cm : SCENE_COLOR_MAP) {
+        if (cm.type == bestType) continue;
+        int reach = minDistance(cm.r, cm.g, cm.b);
+        if (bestType == ParticleType::EMPTY ? reach < matchThreshold : reach <= bestMax) return AMBIGUOUS;
+    }
+
+    if (partlyDark && bestType != ParticleType::EMPTY) return AMBIGUOUS;
+    return (unsigned char)bestType;
+}
+
+float ScenePalette::getAmbiguousFraction() const {
+    size_t ambiguous = std::count(table.begin(), table.end(), AMBIGUOUS);
+    return (float)ambiguous / table.size();
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "SandSimulator.h"  // For ParticleType
+#include <vector>
+
+// Classifies scene image colours as particle types and spawn markers.
+//
+// A pixel matches the closest reference colour within a squared-distance threshold. The
+// answer for every 5-bit-per-channel colour bucket is precomputed on construction; buckets
+// whose colours do not all classify the same way are marked ambiguous and fall back to the
+// exact search, so classify() always agrees with classifyExact().
+class ScenePalette {
+public:
+    // classify() result for the Little Purple Jumper spawn marker (#450981)
+    static constexpr unsigned char JUMPER_MARKER = 0xFE;
+
+    // Rules for scene images (chunk population and baked levels)
+    static constexpr int SCENE_DARK_CUTOFF = 30;        // Skip dark pixels (empty/background) - be more aggressive
+    static constexpr int SCENE_MATCH_THRESHOLD = 3500;  // Reject blended/anti-aliased pixels
+
+    // darkCutoff: pixels with every channel below this are background.
+    // matchThreshold: squared distance a pixel must be within to match a reference colour.
+    ScenePalette(int darkCutoff, int matchThreshold);
+
+    // ParticleType value (EMPTY for background and blended pixels) or JUMPER_MARKER
+    unsigned char classify(int r, int g, int b) const {
+        unsigned char result = table[bucketIndex(r, g, b)];
+        return result == AMBIGUOUS ? classifyExact(r, g, b) : result;
+    }
+
+    // Reference search without the table
+    unsigned char classifyExact(int r, int g, int b) const;
+
+    // Fraction of buckets that need the exact search
+    float getAmbiguousFraction() const;
+
+private:
+    static constexpr unsigned char AMBIGUOUS = 0xFF;
+    static constexpr int BUCKET_BITS = 5;
+
+    int darkCutoff;
+    int matchThreshold;
+    std::vector<unsigned char> table;  // 32K buckets, indexed r:g:b
+
+    static int bucketIndex(int r, int g, int b) {
+        constexpr int shift = 8 - BUCKET_BITS;
+        return ((r >> shift) << (2 * BUCKET_BITS)) | ((g >> shift) << BUCKET_BITS) | (b >> shift);
+    }
+    unsigned char classifyBucket(int r0, int g0, int b0) const;
+};
@@ -0,0 +1,146 @@
+#include "SimulationLoop.h"
+#include "World.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+SimulationLoop::SimulationLoop(World& world, int viewportWidth, int viewportHeight)
+    : world(world)
+    , renderer(viewportWidth + 2 * SNAPSHOT_MARGIN, viewportHeight + 2 * SNAPSHOT_MARGIN)
+{
+    const Config& config = world.getConfig();
+    stepSeconds = config.simulationStepsPerSecond > 0 ? 1.0f / config.simulationStepsPerSecond : 0.0f;
+    maxCatchUpSteps = std::max(1, config.simulationMaxCatchUpSteps);
+
+    for (Snapshot& snapshot : buffers) {
+        snapshot.pixels.assign(renderer.getWidth() * renderer.getHeight(), 0);
+    }
+    secondStart = Clock::now();
+}
+
+SimulationLoop::~SimulationLoop() {
+    stop();
+}
+
+void SimulationLoop::start() {
+    if (stepSeconds <= 0.0f || thread.joinable()) return;
+
+    running = true;
+    thread = std::thread(&SimulationLoop::threadLoop, this);
+}
+
+void SimulationLoop::stop() {
+    running = false;
+    if (thread.joinable()) thread.join();
+}
+
+std::unique_lock<std::mutex> SimulationLoop::lockWorld() {
+    mainWaiting.fetch_add(1, std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(worldMutex);
+    mainWaiting.fetch_sub(1, std::memory_order_release);
+    return lock;
+}
+
+void SimulationLoop::advance(float seconds) {
+    backlogSeconds += seconds;
+    runDueSteps(false);
+    publish(false);
+}
+
+const SimulationLoop::Snapshot& SimulationLoop::acquireSnapshot() {
+    std::lock_guard<std::mutex> lock(snapshotMutex);
+    if (readyIsNew) {
+        std::swap(frontIndex, readyIndex);
+        readyIsNew = false;
+    }
+    return buffers[frontIndex];
+}
+
+void SimulationLoop::threadLoop() {
+    auto last = Clock::now();
+
+    while (running) {
+        auto now = Clock::now();
+        backlogSeconds += std::chrono::duration<double>(now - last).count();
+        last = now;
+
+        if (runDueSteps(true) > 0) publish(true);
+
+        // Sleep until the next step is due
+        double wait = stepSeconds - backlogSeconds;
+        if (wait > 0.0) std::this_thread::sleep_for(std::chrono::duration<double>(wait));
+    }
+}
+
+std::unique_lock<std::mutex> SimulationLoop::lockIfThreaded(bool threaded) {
+    if (!threaded) return {};
+
+    // Let the main thread in first: it holds the world only briefly each frame
+    while (mainWaiting.load(std::memory_order_acquire) > 0) std::this_thread::yield();
+    return std::unique_lock<std::mutex>(worldMutex);
+}
+
+int SimulationLoop::runDueSteps(bool threaded) {
+    if (stepSeconds <= 0.0f) {
+        backlogSeconds = 0.0;
+        return 0;
+    }
+
+    int steps = 0;
+    while (backlogSeconds >= stepSeconds && steps < maxCatchUpSteps) {
+        {
+            auto lock = lockIfThreaded(threaded);
+            world.update(stepSeconds);
+        }
+        backlogSeconds -= stepSeconds;
+        countStep();
+        steps++;
+    }
+
+    // Too far behind to catch up: drop the whole steps still owed, keep the remainder
+    if (backlogSeconds >= stepSeconds) {
+        double skipped = std::floor(backlogSeconds / stepSeconds);
+        skippedSteps.fetch_add((uint64_t)skipped, std::memory_order_relaxed);
+        backlogSeconds -= skipped * stepSeconds;
+    }
+    return steps;
+}
+
+void SimulationLoop::countStep() {
+    stepsThisSecond++;
+    auto now = Clock::now();
+    if (now - secondStart >= std::chrono::seconds(1)) {
+        stepsPerSecond.store(stepsThisSecond, std::memory_order_relaxed);
+        stepsThisSecond = 0;
+        secondStart = now;
+    }
+}
+
+void SimulationLoop::publish(bool threaded) {
+    PROFILE_SCOPE("snapshot publish");
+    int left, top;
+    {
+        // The camera is moved by the main thread under the world lock; the margin lets the
+        // display scroll a little past where the snapshot was taken
+        auto lock = lockIfThreaded(threaded);
+        const Camera& camera = world.getCamera();
+        left = std::clamp((int)camera.x - SNAPSHOT_MARGIN, 0, World::WORLD_WIDTH - renderer.getWidth());
+        top = std::clamp((int)camera.y - SNAPSHOT_MARGIN, 0, World::WORLD_HEIGHT - renderer.getHeight());
+        renderer.capture(world, left, top);
+    }
+
+    renderer.rasterise();
+    bool changed = !renderer.finishFrame().empty();
+    if (!changed && publishedSequence > 0) return;
+
+    Snapshot& back = buffers[backIndex];
+    std::memcpy(back.pixels.data(), renderer.getPixels().data(), back.pixels.size() * sizeof(uint32_t));
+    back.left = left;
+    back.top = top;
+    back.sequence = ++publishedSequence;
+
+    std::lock_guard<std::mutex> lock(snapshotMutex);
+    std::swap(backIndex, readyIndex);
+    readyIsNew = true;
+}
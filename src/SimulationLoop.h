@@ -0,0 +1,101 @@
+#pragma once
+#include "ViewportRenderer.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class World;
+
+// Runs World::update at a fixed timestep, either on its own thread or from the frame loop,
+// and publishes what the camera sees after each batch of steps.
+//
+// Steps that fall due while the simulation is behind are run back to back, up to
+// simulationMaxCatchUpSteps at a time; any older backlog is skipped rather than replayed,
+// so a slow simulation runs at its own pace instead of stalling the display.
+//
+// The published snapshot is the region around the camera (viewport plus SNAPSHOT_MARGIN
+// on each side) rasterised after the last step. The render thread draws from the newest
+// snapshot without touching the world, and can scroll within the margin at display rate.
+// Everything else that reads or changes the world must hold lockWorld().
+//
+// The simulation thread takes the world for one step at a time, and for publishing only
+// long enough to copy the cells that changed (ViewportRenderer::capture); the snapshot is
+// rasterised after the world is released. A waiting main thread goes ahead of the next
+// step, so it waits for at most the step in progress.
+class SimulationLoop {
+public:
+    static constexpr int SNAPSHOT_MARGIN = 32;
+
+    struct Snapshot {
+        std::vector<uint32_t> pixels;  // ARGB8888, getSnapshotWidth() x getSnapshotHeight()
+        int left = 0, top = 0;         // World position of the top-left pixel
+        uint64_t sequence = 0;         // Increases with every published snapshot (0 = none yet)
+    };
+
+    SimulationLoop(World& world, int viewportWidth, int viewportHeight);
+    ~SimulationLoop();
+    SimulationLoop(const SimulationLoop&) = delete;
+    SimulationLoop& operator=(const SimulationLoop&) = delete;
+
+    // Step on a background thread until stop() (no-op without a simulation rate)
+    void start();
+    void stop();
+    bool isThreaded() const { return thread.joinable(); }
+
+    // Exclusive access to the world. Waits for a step or capture in progress; the simulation
+    // thread does not begin another while the main thread is waiting.
+    std::unique_lock<std::mutex> lockWorld();
+
+    // Without a thread: run the steps due after `seconds` of real time, then publish.
+    // The caller must hold lockWorld() (or no thread is running).
+    void advance(float seconds);
+
+    // Newest published snapshot (render thread). Stays valid until the next call.
+    const Snapshot& acquireSnapshot();
+
+    int getSnapshotWidth() const { return renderer.getWidth(); }
+    int getSnapshotHeight() const { return renderer.getHeight(); }
+
+    // Steps run in the last whole second, and steps skipped since the start
+    int getStepsPerSecond() const { return stepsPerSecond.load(std::memory_order_relaxed); }
+    uint64_t getSkippedSteps() const { return skippedSteps.load(std::memory_order_relaxed); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    World& world;
+    float stepSeconds;  // 0 = no simulation
+    int maxCatchUpSteps;
+
+    std::mutex worldMutex;
+    std::atomic<int> mainWaiting{0};
+    std::thread thread;
+    std::atomic<bool> running{false};
+    double backlogSeconds = 0.0;  // Real time not yet simulated
+
+    // Snapshot triple buffer: the simulation fills back, ready is the newest complete
+    // snapshot, the render thread reads front
+    ViewportRenderer renderer;
+    Snapshot buffers[3];
+    int backIndex = 0, readyIndex = 1, frontIndex = 2;
+    bool readyIsNew = false;
+    uint64_t publishedSequence = 0;
+    std::mutex snapshotMutex;
+
+    std::atomic<int> stepsPerSecond{0};
+    std::atomic<uint64_t> skippedSteps{0};
+    int stepsThisSecond = 0;
+    Clock::time_point secondStart;
+
+    void threadLoop();
+
+    // With `threaded`, these lock the world themselves, around each step and the capture;
+    // otherwise the caller holds it
+    std::unique_lock<std::mutex> lockIfThreaded(bool threaded);
+    int runDueSteps(bool threaded);  // Returns steps run
+    void countStep();
+    void publish(bool threaded);
+};
@@ -1,4 +1,5 @@
 #include "SparkBolt.h"
+#include "Random.h"
 #include "BulletConfig.h"
 #include "SpellModifier.h"
 #include <algorithm>
@@ -25,7 +26,7 @@ void SparkBolt::fire(World& world, float x, float y, float angle, int damage) {
     const auto& cfg = BulletConfigs::SparkBolt;
 
     for (int i = 0; i < projectileCount; ++i) {
-        float spreadAngle = spread * ((float)rand() / RAND_MAX - 0.5f);
+        float spreadAngle = spread * (Random::local().uniform() - 0.5f);
         float fireAngle = angle + spreadAngle;
 
         Bullet bullet(x, y, std::cos(fireAngle), std::sin(fireAngle), damage);
@@ -40,7 +41,7 @@ void SparkBolt::fire(World& world, float x, float y, float angle, int damage) {
     }
 }
 
-void SparkBolt::update(float deltaTime, World& world, std::vector<LittlePurpleJumper>& enemies) {
+void SparkBolt::update(float deltaTime, World& world, const EnemyGrid& enemies) {
     for (auto& bullet : bullets) {
         if (!bullet.active) continue;
 
@@ -1,4 +1,5 @@
 #include "SpellModifier.h"
+#include "Random.h"
 #include "Bullet.h"
 #include "World.h"
 #include <cstdlib>
@@ -11,7 +12,7 @@ void DamageUpModifier::onFire(Bullet& bullet) {
 }
 
 void CriticalHitModifier::onFire(Bullet& bullet) {
-    float roll = (float)rand() / RAND_MAX;
+    float roll = Random::local().uniform();
     if (roll < critChance) {
         bullet.damage = (int)(bullet.damage * critMultiplier);
         bullet.isCritical = true;
@@ -1,29 +1,28 @@
 #include "Texturize.h"
-#include "World.h"
+#include "ChunkCanvas.h"
 #include "WorldChunk.h"
 #include "Config.h"
+#include "Random.h"
 #include <cstdlib>
 #include <algorithm>
 #include <cmath>
 
-void Texturize::apply(World* world, WorldChunk* chunk, ParticleType targetType, const TextureParams& params) {
-    if (!world || !chunk) return;
+void Texturize::apply(ChunkCanvas& canvas, ParticleType targetType, const TextureParams& params) {
+    const Config& config = canvas.getConfig();
 
-    const Config& config = world->getConfig();
-
-    int chunkWorldX = chunk->getWorldX();
-    int chunkWorldY = chunk->getWorldY();
+    int chunkWorldX = canvas.getChunk().getWorldX();
+    int chunkWorldY = canvas.getChunk().getWorldY();
 
     for (int y = 0; y < WorldChunk::CHUNK_SIZE; ++y) {
         for (int x = 0; x < WorldChunk::CHUNK_SIZE; ++x) {
             int worldX = chunkWorldX + x;
             int worldY = chunkWorldY + y;
 
-            ParticleType type = world->getParticle(worldX, worldY);
+            ParticleType type = canvas.getParticle(worldX, worldY);
             if (type == targetType) {
-                if (params.spawnChance > 0 && (float)std::rand() / RAND_MAX < params.spawnChance) {
-                    int patch_size = params.minPatchSize + std::rand() % (params.maxPatchSize - params.minPatchSize + 1);
-                    float patch_radius = params.minPatchRadius + (float)(std::rand()) / (float)(RAND_MAX / (params.maxPatchRadius - params.minPatchRadius));
+                if (params.spawnChance > 0 && Random::local().chance(params.spawnChance)) {
+                    int patch_size = Random::local().range(params.minPatchSize, params.maxPatchSize);
+                    float patch_radius = params.minPatchRadius + Random::local().uniform() * (params.maxPatchRadius - params.minPatchRadius);
 
                     for (int dy = -patch_size / 2; dy <= patch_size / 2; ++dy) {
                         for (int dx = -patch_size / 2; dx <= patch_size / 2; ++dx) {
@@ -31,9 +30,9 @@ void Texturize::apply(World* world, WorldChunk* chunk, ParticleType targetType,
                                 int currentX = worldX + dx;
                                 int currentY = worldY + dy;
 
-                                if (world->inWorldBounds(currentX, currentY) && world->getParticle(currentX, currentY) == targetType) {
-                                    ParticleColor color = world->getColor(currentX, currentY);
-                                    world->setColor(currentX, currentY, {
+                                if (canvas.inWorldBounds(currentX, currentY) && canvas.getParticle(currentX, currentY) == targetType) {
+                                    ParticleColor color = canvas.getColor(currentX, currentY);
+                                    canvas.setColor(currentX, currentY, {
                                         static_cast<unsigned char>(color.r * params.colorMultiplier),
                                         static_cast<unsigned char>(color.g * params.colorMultiplier),
                                         static_cast<unsigned char>(color.b * params.colorMultiplier)
@@ -48,10 +47,8 @@ void Texturize::apply(World* world, WorldChunk* chunk, ParticleType targetType,
     }
 }
 
-void Texturize::applyBrickTexture(World* world, WorldChunk* chunk) {
-    if (!world || !chunk) return;
-
-    const Config& config = world->getConfig();
+void Texturize::applyBrickTexture(ChunkCanvas& canvas) {
+    const Config& config = canvas.getConfig();
     if (!config.rock.brickTextureEnabled) return;
 
     const int BRICK_W = config.rock.brickWidth;
@@ -61,20 +58,20 @@ void Texturize::applyBrickTexture(World* world, WorldChunk* chunk) {
     const int TOTAL_BRICK_W = BRICK_W + MORTAR_SIZE;
     const int TOTAL_BRICK_H = BRICK_H + MORTAR_SIZE;
 
-    int chunkWorldX = chunk->getWorldX();
-    int chunkWorldY = chunk->getWorldY();
+    int chunkWorldX = canvas.getChunk().getWorldX();
+    int chunkWorldY = canvas.getChunk().getWorldY();
 
     for (int y = 0; y < WorldChunk::CHUNK_SIZE; ++y) {
         for (int x = 0; x < WorldChunk::CHUNK_SIZE; ++x) {
             int worldX = chunkWorldX + x;
             int worldY = chunkWorldY + y;
 
-            if (world->getParticle(worldX, worldY) != ParticleType::ROCK) {
+            if (canvas.getParticle(worldX, worldY) != ParticleType::ROCK) {
                 continue;
             }
             
             // Overall sparsity check
-            if ((float)std::rand() / RAND_MAX > config.rock.overallSparsity) {
+            if (Random::local().uniform() > config.rock.overallSparsity) {
                 continue;
             }
 
@@ -93,7 +90,7 @@ void Texturize::applyBrickTexture(World* world, WorldChunk* chunk) {
             float brick_rand_main = (float)(brick_hash % 1000) / 1000.0f;
             float brick_rand_type = (float)((brick_hash >> 8) % 1000) / 1000.0f; // Another random for type
 
-            ParticleColor color = world->getColor(worldX, worldY);
+            ParticleColor color = canvas.getColor(worldX, worldY);
 
             // Integrate long lines into mortar determination
             if (!is_mortar) { // Only check if not already regular mortar
@@ -109,7 +106,7 @@ void Texturize::applyBrickTexture(World* world, WorldChunk* chunk) {
 
 
             if (is_mortar) {
-                world->setColor(worldX, worldY, {
+                canvas.setColor(worldX, worldY, {
                     static_cast<unsigned char>(static_cast<float>(color.r) * config.rock.mortarColorMultiplier),
                     static_cast<unsigned char>(static_cast<float>(color.g) * config.rock.mortarColorMultiplier),
                     static_cast<unsigned char>(static_cast<float>(color.b) * config.rock.mortarColorMultiplier)
@@ -120,13 +117,13 @@ void Texturize::applyBrickTexture(World* world, WorldChunk* chunk) {
                 int y_in_brick = y_mortar_check - MORTAR_SIZE;
                 
                 if (brick_rand_type < config.rock.darkBrickChance) { // Dark brick
-                    world->setColor(worldX, worldY, { 
+                    canvas.setColor(worldX, worldY, { 
                         static_cast<unsigned char>(static_cast<float>(color.r) * config.rock.darkBrickColorMultiplier),
                         static_cast<unsigned char>(static_cast<float>(color.g) * config.rock.darkBrickColorMultiplier),
                         static_cast<unsigned char>(static_cast<float>(color.b) * config.rock.darkBrickColorMultiplier)
                     });
                 } else if (brick_rand_type < config.rock.darkBrickChance + config.rock.lightBrickChance) { // Light brick
-                     world->setColor(worldX, worldY, { 
+                     canvas.setColor(worldX, worldY, { 
                         static_cast<unsigned char>(std::min(255.0f, static_cast<float>(color.r) * config.rock.lightBrickColorMultiplier)), 
                         static_cast<unsigned char>(std::min(255.0f, static_cast<float>(color.g) * config.rock.lightBrickColorMultiplier)), 
                         static_cast<unsigned char>(std::min(255.0f, static_cast<float>(color.b) * config.rock.lightBrickColorMultiplier)) 
@@ -134,7 +131,7 @@ void Texturize::applyBrickTexture(World* world, WorldChunk* chunk) {
                 } else if (brick_rand_type < config.rock.darkBrickChance + config.rock.lightBrickChance + config.rock.borderedBrickChance) { // Bordered brick
                      bool is_outline = (x_in_brick < MORTAR_SIZE || x_in_brick >= BRICK_W - MORTAR_SIZE || y_in_brick < MORTAR_SIZE || y_in_brick >= BRICK_H - MORTAR_SIZE);
                      if(is_outline) {
-                        world->setColor(worldX, worldY, { 
+                        canvas.setColor(worldX, worldY, { 
                             static_cast<unsigned char>(static_cast<float>(color.r) * config.rock.brickOutlineColorMultiplier), 
                             static_cast<unsigned char>(static_cast<float>(color.g) * config.rock.brickOutlineColorMultiplier), 
                             static_cast<unsigned char>(static_cast<float>(color.b) * config.rock.brickOutlineColorMultiplier) 
@@ -144,7 +141,7 @@ void Texturize::applyBrickTexture(World* world, WorldChunk* chunk) {
                      if (brick_rand_type < config.rock.darkBrickChance + config.rock.lightBrickChance + config.rock.borderedBrickChance + config.rock.thickBorderBrickChance) { // Thick border brick
                         bool is_thick_outline = ( (x_in_brick >= BRICK_W - MORTAR_SIZE * 2) || (y_in_brick >= BRICK_H - MORTAR_SIZE * 2) );
                         if(is_thick_outline) {
-                            world->setColor(worldX, worldY, { 
+                            canvas.setColor(worldX, worldY, { 
                                 static_cast<unsigned char>(static_cast<float>(color.r) * config.rock.brickOutlineColorMultiplier), 
                                 static_cast<unsigned char>(static_cast<float>(color.g) * config.rock.brickOutlineColorMultiplier), 
                                 static_cast<unsigned char>(static_cast<float>(color.b) * config.rock.brickOutlineColorMultiplier) 
@@ -158,14 +155,12 @@ void Texturize::applyBrickTexture(World* world, WorldChunk* chunk) {
     }
 }
 
-void Texturize::applyRockBorders(World* world, WorldChunk* chunk) {
-    if (!world || !chunk) return;
-
-    const Config& config = world->getConfig();
+void Texturize::applyRockBorders(ChunkCanvas& canvas) {
+    const Config& config = canvas.getConfig();
     if (!config.rock.borderEnabled) return;
 
-    int chunkWorldX = chunk->getWorldX();
-    int chunkWorldY = chunk->getWorldY();
+    int chunkWorldX = canvas.getChunk().getWorldX();
+    int chunkWorldY = canvas.getChunk().getWorldY();
     int borderWidth = config.rock.borderWidth;
     bool islandExcluded = config.rock.borderIslandExcluded;
     bool ignoreMoss = config.rock.borderIgnoreMoss;
@@ -193,9 +188,9 @@ void Texturize::applyRockBorders(World* world, WorldChunk* chunk) {
             int worldX = areaStartX + x;
             int worldY = areaStartY + y;
 
-            if (!world->inWorldBounds(worldX, worldY)) {
+            if (!canvas.inWorldBounds(worldX, worldY)) {
                 regionMap[y][x] = -1; // Out of bounds = non-rock
-            } else if (!isRockLike(world->getParticle(worldX, worldY))) {
+            } else if (!isRockLike(canvas.getParticle(worldX, worldY))) {
                 regionMap[y][x] = -1; // Non-rock material
             }
         }
@@ -247,7 +242,7 @@ void Texturize::applyRockBorders(World* world, WorldChunk* chunk) {
             int worldX = chunkWorldX + x;
             int worldY = chunkWorldY + y;
 
-            if (world->getParticle(worldX, worldY) != ParticleType::ROCK) {
+            if (canvas.getParticle(worldX, worldY) != ParticleType::ROCK) {
                 distanceMap[y][x] = 0.0f;
                 continue;
             }
@@ -303,7 +298,7 @@ void Texturize::applyRockBorders(World* world, WorldChunk* chunk) {
             int worldX = chunkWorldX + x;
             int worldY = chunkWorldY + y;
 
-            if (world->getParticle(worldX, worldY) != ParticleType::ROCK) {
+            if (canvas.getParticle(worldX, worldY) != ParticleType::ROCK) {
                 continue;
             }
 
@@ -319,8 +314,8 @@ void Texturize::applyRockBorders(World* world, WorldChunk* chunk) {
                 // Island edge: only outer line (dist <= 1.5), 2x lighter than normal outer
                 if (dist <= 1.5f) {
                     float islandMult = 1.0f - (1.0f - outerMult) * 0.5f; // Half the darkening
-                    ParticleColor color = world->getColor(worldX, worldY);
-                    world->setColor(worldX, worldY, {
+                    ParticleColor color = canvas.getColor(worldX, worldY);
+                    canvas.setColor(worldX, worldY, {
                         static_cast<unsigned char>(std::max(0.0f, std::min(255.0f,
                             static_cast<float>(color.r) * islandMult))),
                         static_cast<unsigned char>(std::max(0.0f, std::min(255.0f,
@@ -349,8 +344,8 @@ void Texturize::applyRockBorders(World* world, WorldChunk* chunk) {
             }
 
             if (applyPattern) {
-                ParticleColor color = world->getColor(worldX, worldY);
-                world->setColor(worldX, worldY, {
+                ParticleColor color = canvas.getColor(worldX, worldY);
+                canvas.setColor(worldX, worldY, {
                     static_cast<unsigned char>(std::max(0.0f, std::min(255.0f,
                         static_cast<float>(color.r) * colorMult))),
                     static_cast<unsigned char>(std::max(0.0f, std::min(255.0f,
@@ -363,14 +358,12 @@ void Texturize::applyRockBorders(World* world, WorldChunk* chunk) {
     }
 }
 
-void Texturize::applyObsidianBorders(World* world, WorldChunk* chunk) {
-    if (!world || !chunk) return;
-
-    const Config& config = world->getConfig();
+void Texturize::applyObsidianBorders(ChunkCanvas& canvas) {
+    const Config& config = canvas.getConfig();
     if (!config.obsidian.borderEnabled) return;
 
-    int chunkWorldX = chunk->getWorldX();
-    int chunkWorldY = chunk->getWorldY();
+    int chunkWorldX = canvas.getChunk().getWorldX();
+    int chunkWorldY = canvas.getChunk().getWorldY();
     int borderWidth = config.obsidian.borderWidth;
     bool islandExcluded = config.obsidian.borderIslandExcluded;
     bool ignoreMoss = config.obsidian.borderIgnoreMoss;
@@ -394,9 +387,9 @@ void Texturize::applyObsidianBorders(World* world, WorldChunk* chunk) {
             int worldX = areaStartX + x;
             int worldY = areaStartY + y;
 
-            if (!world->inWorldBounds(worldX, worldY)) {
+            if (!canvas.inWorldBounds(worldX, worldY)) {
                 regionMap[y][x] = -1;
-            } else if (!isObsidianLike(world->getParticle(worldX, worldY))) {
+            } else if (!isObsidianLike(canvas.getParticle(worldX, worldY))) {
                 regionMap[y][x] = -1;
             }
         }
@@ -445,7 +438,7 @@ void Texturize::applyObsidianBorders(World* world, WorldChunk* chunk) {
             int worldX = chunkWorldX + x;
             int worldY = chunkWorldY + y;
 
-            if (world->getParticle(worldX, worldY) != ParticleType::OBSIDIAN) {
+            if (canvas.getParticle(worldX, worldY) != ParticleType::OBSIDIAN) {
                 distanceMap[y][x] = 0.0f;
                 continue;
             }
@@ -497,7 +490,7 @@ void Texturize::applyObsidianBorders(World* world, WorldChunk* chunk) {
             int worldX = chunkWorldX + x;
             int worldY = chunkWorldY + y;
 
-            if (world->getParticle(worldX, worldY) != ParticleType::OBSIDIAN) {
+            if (canvas.getParticle(worldX, worldY) != ParticleType::OBSIDIAN) {
                 continue;
             }
 
@@ -512,8 +505,8 @@ void Texturize::applyObsidianBorders(World* world, WorldChunk* chunk) {
             if (isIslandEdge) {
                 if (dist <= 1.5f) {
                     float islandMult = 1.0f - (1.0f - outerMult) * 0.5f;
-                    ParticleColor color = world->getColor(worldX, worldY);
-                    world->setColor(worldX, worldY, {
+                    ParticleColor color = canvas.getColor(worldX, worldY);
+                    canvas.setColor(worldX, worldY, {
                         static_cast<unsigned char>(std::max(0.0f, std::min(255.0f,
                             static_cast<float>(color.r) * islandMult))),
                         static_cast<unsigned char>(std::max(0.0f, std::min(255.0f,
@@ -540,8 +533,8 @@ void Texturize::applyObsidianBorders(World* world, WorldChunk* chunk) {
             }
 
             if (applyPattern) {
-                ParticleColor color = world->getColor(worldX, worldY);
-                world->setColor(worldX, worldY, {
+                ParticleColor color = canvas.getColor(worldX, worldY);
+                canvas.setColor(worldX, worldY, {
                     static_cast<unsigned char>(std::max(0.0f, std::min(255.0f,
                         static_cast<float>(color.r) * colorMult))),
                     static_cast<unsigned char>(std::max(0.0f, std::min(255.0f,
@@ -1,8 +1,7 @@
 #pragma once
 
 // Forward declarations
-class World;
-class WorldChunk;
+class ChunkCanvas;
 enum class ParticleType : unsigned char;
 
 struct TextureParams {
@@ -16,8 +15,8 @@ struct TextureParams {
 
 class Texturize {
 public:
-    void apply(World* world, WorldChunk* chunk, ParticleType targetType, const TextureParams& params);
-    void applyBrickTexture(World* world, WorldChunk* chunk);
-    void applyRockBorders(World* world, WorldChunk* chunk);
-    void applyObsidianBorders(World* world, WorldChunk* chunk);
+    void apply(ChunkCanvas& canvas, ParticleType targetType, const TextureParams& params);
+    void applyBrickTexture(ChunkCanvas& canvas);
+    void applyRockBorders(ChunkCanvas& canvas);
+    void applyObsidianBorders(ChunkCanvas& canvas);
 };
@@ -0,0 +1,257 @@
+#include "ViewportRenderer.h"
+#include "World.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+static constexpr int TILE = World::RENDER_TILE_SIZE;
+
+// Call fn(chunk, localX, localY, count, worldX) for each chunk-sized piece of a world row
+// (chunk is nullptr where nothing is loaded)
+template <typename Fn>
+static void forEachRowSegment(const World& world, int worldY, int startX, int endX, Fn fn) {
+    int chunkY = worldY / WorldChunk::CHUNK_SIZE;
+    int localY = worldY % WorldChunk::CHUNK_SIZE;
+    for (int x = startX; x < endX;) {
+        int chunkX = x / WorldChunk::CHUNK_SIZE;
+        int segmentEnd = std::min(endX, (chunkX + 1) * WorldChunk::CHUNK_SIZE);
+        fn(world.findChunk(chunkX, chunkY), x % WorldChunk::CHUNK_SIZE, localY, segmentEnd - x, x);
+        x = segmentEnd;
+    }
+}
+
+// Additive fire glow: a fire cell brightens itself and the FIRE_GLOW_HEIGHT pixels above it.
+// Intensity 1, 0.75, 0.5, 0.25 going up: alpha is intensity * 120, and the colour (scaled
+// by intensity) is added at that alpha, so the colour weight is intensity^2 * 120.
+static void addGlow(uint32_t& pixel, ParticleColor color, int height) {
+    static const int GLOW_ALPHA[World::FIRE_GLOW_HEIGHT + 1] = {120, 90, 60, 30};
+    static const int GLOW_WEIGHTS[World::FIRE_GLOW_HEIGHT + 1] = {120, 68, 30, 8};
+
+    int weight = GLOW_WEIGHTS[height];
+    int r = std::min(255, (int)((pixel >> 16) & 0xFF) + color.r * weight / 255);
+    int g = std::min(255, (int)((pixel >> 8) & 0xFF) + color.g * weight * 7 / 2550);
+    // Transparent pixels (z-layers behind) take on the glow's own alpha
+    uint32_t alpha = std::max(pixel >> 24, (uint32_t)GLOW_ALPHA[height]);
+    pixel = (alpha << 24) | (r << 16) | (g << 8) | (pixel & 0xFF);
+}
+
+ViewportRenderer::ViewportRenderer(int width, int height)
+    : width(width)
+    , height(height)
+    , raster(width * height, 0)
+    , pixels(width * height, 0)
+{
+}
+
+void ViewportRenderer::capture(World& world, int left, int top) {
+    PROFILE_SCOPE("render capture");
+    int dx = left - lastLeft;
+    int dy = top - lastTop;
+    bool scrolled = !hasRaster || dx != 0 || dy != 0;
+    bool keepRaster = hasRaster && std::abs(dx) < width && std::abs(dy) < height;
+    lastLeft = left;
+    lastTop = top;
+    hasRaster = true;
+
+    firstTileX = left / TILE;
+    firstTileY = top / TILE;
+    tilesX = (left + width - 1) / TILE - firstTileX + 1;
+    tilesY = (top + height - 1) / TILE - firstTileY + 1;
+    tileChanged.assign(tilesX * tilesY, 0);
+    if (scrolled) overlayTiles.assign(tilesX * tilesY, 0);  // The whole frame is recomposed
+
+    capturedRects.clear();
+    capturedCells = 0;
+    capturedBallistics.clear();
+    scrolledPending = scrolled;
+    shiftPending = scrolled && keepRaster;
+    shiftX = dx;
+    shiftY = dy;
+
+    // Scrolling: what is still visible moves, the strips that came into view are drawn
+    if (scrolled && keepRaster) {
+        if (dx > 0) captureRect(world, left, top, width - dx, 0, width, height);
+        if (dx < 0) captureRect(world, left, top, 0, 0, -dx, height);
+        if (dy > 0) captureRect(world, left, top, 0, height - dy, width, height);
+        if (dy < 0) captureRect(world, left, top, 0, 0, width, -dy);
+    } else if (scrolled) {
+        captureRect(world, left, top, 0, 0, width, height);
+    }
+
+    // Tiles the world changed (flags of every visible tile are consumed, even when the
+    // whole raster is about to be drawn)
+    for (int i = 0; i < tilesX * tilesY; ++i) {
+        if (!world.takeRenderDirty(firstTileX + i % tilesX, firstTileY + i / tilesX)) continue;
+        if (scrolled && !keepRaster) continue;
+
+        Rect rect = tileRect(i);
+        captureRect(world, left, top, rect.x, rect.y, rect.x + rect.w, rect.y + rect.h);
+        tileChanged[i] = 1;
+    }
+
+    // Particles in flight are not in the grid: they are drawn over the raster like overlays
+    const BallisticParticles& ballistics = world.getBallistics();
+    for (int i = 0; i < ballistics.size(); ++i) {
+        int x = (int)ballistics.x[i] - left;
+        int y = (int)ballistics.y[i] - top;
+        if (x < 0 || y < 0 || x >= width || y >= height) continue;
+        ParticleColor color = ballistics.color[i];
+        capturedBallistics.push_back({x, y, 0xFF000000u | ((uint32_t)color.r << 16) | ((uint32_t)color.g << 8) | color.b});
+    }
+}
+
+void ViewportRenderer::rasterise() {
+    rasterisedPixels = 0;
+
+    if (shiftPending) shiftRaster(shiftX, shiftY);
+    for (const CapturedRect& rect : capturedRects) {
+        rasteriseRect(rect);
+    }
+
+    // Compose: the frame is the raster, except where overlays drew last frame
+    if (scrolledPending) {
+        std::memcpy(pixels.data(), raster.data(), raster.size() * sizeof(uint32_t));
+        fullUpload = true;
+    } else {
+        for (int i = 0; i < tilesX * tilesY; ++i) {
+            if (!tileChanged[i] && !overlayTiles[i]) continue;
+
+            Rect rect = tileRect(i);
+            for (int y = rect.y; y < rect.y + rect.h; ++y) {
+                std::memcpy(&pixels[y * width + rect.x], &raster[y * width + rect.x], rect.w * sizeof(uint32_t));
+            }
+            tileChanged[i] = 1;
+        }
+    }
+
+    for (const CapturedPixel& pixel : capturedBallistics) {
+        pixels[pixel.y * width + pixel.x] = pixel.argb;
+    }
+}
+
+const std::vector<ViewportRenderer::Rect>& ViewportRenderer::finishFrame() {
+    // Tiles overlays drew into differ from the raster; they are restored next frame
+    for (int i = 0; i < tilesX * tilesY; ++i) {
+        Rect rect = tileRect(i);
+        bool covered = false;
+        for (int y = rect.y; y < rect.y + rect.h && !covered; ++y) {
+            covered = std::memcmp(&pixels[y * width + rect.x], &raster[y * width + rect.x], rect.w * sizeof(uint32_t)) != 0;
+        }
+        overlayTiles[i] = covered;
+        if (covered) tileChanged[i] = 1;
+    }
+
+    uploadRects.clear();
+    if (fullUpload) {
+        uploadRects.push_back({0, 0, width, height});
+        fullUpload = false;
+    } else {
+        for (int tileY = 0; tileY < tilesY; ++tileY) {
+            for (int tileX = 0; tileX < tilesX;) {
+                int first = tileY * tilesX + tileX;
+                if (!tileChanged[first]) {
+                    tileX++;
+                    continue;
+                }
+
+                while (tileX < tilesX && tileChanged[tileY * tilesX + tileX]) tileX++;
+                Rect firstRect = tileRect(first);
+                Rect lastRect = tileRect(tileY * tilesX + tileX - 1);
+                uploadRects.push_back({firstRect.x, firstRect.y, lastRect.x + lastRect.w - firstRect.x, firstRect.h});
+            }
+        }
+    }
+
+    uploadedPixels = 0;
+    for (const Rect& rect : uploadRects) uploadedPixels += rect.w * rect.h;
+    return uploadRects;
+}
+
+void ViewportRenderer::shiftRaster(int dx, int dy) {
+    // Pixel (x, y) takes the old pixel (x + dx, y + dy); rows are walked so that no source
+    // row is overwritten before it is copied
+    auto copyRow = [&](int y) {
+        uint32_t* dst = &raster[y * width];
+        const uint32_t* src = &raster[(y + dy) * width];
+        if (dx >= 0) std::memmove(dst, src + dx, (width - dx) * sizeof(uint32_t));
+        else std::memmove(dst - dx, src, (width + dx) * sizeof(uint32_t));
+    };
+
+    if (dy >= 0) {
+        for (int y = 0; y < height - dy; ++y) copyRow(y);
+    } else {
+        for (int y = height - 1; y >= -dy; --y) copyRow(y);
+    }
+}
+
+void ViewportRenderer::captureRect(const World& world, int left, int top, int x0, int y0, int x1, int y1) {
+    if (x0 >= x1 || y0 >= y1) return;
+
+    // Fire up to FIRE_GLOW_HEIGHT rows below the rectangle glows into it
+    int rectWidth = x1 - x0;
+    int rows = std::min(top + y1 + World::FIRE_GLOW_HEIGHT, World::WORLD_HEIGHT) - (top + y0);
+    size_t offset = capturedCells;
+    capturedCells += (size_t)rows * rectWidth;
+    if (capturedTypes.size() < capturedCells) {
+        capturedTypes.resize(capturedCells);
+        capturedColors.resize(capturedCells);
+    }
+
+    for (int row = 0; row < rows; ++row) {
+        forEachRowSegment(world, top + y0 + row, left + x0, left + x1,
+            [&](const WorldChunk* chunk, int localX, int localY, int count, int worldX) {
+                size_t out = offset + (size_t)row * rectWidth + (worldX - left - x0);
+                if (chunk) {
+                    int first = localY * WorldChunk::CHUNK_SIZE + localX;
+                    std::copy_n(chunk->getParticleGrid().data() + first, count, &capturedTypes[out]);
+                    std::copy_n(chunk->getColorGrid().data() + first, count, &capturedColors[out]);
+                } else {
+                    std::fill_n(&capturedTypes[out], count, ParticleType::EMPTY);
+                    std::fill_n(&capturedColors[out], count, ParticleColor{0, 0, 0});
+                }
+            });
+    }
+    capturedRects.push_back({x0, y0, x1, y1, rows, offset});
+}
+
+void ViewportRenderer::rasteriseRect(const CapturedRect& rect) {
+    int rectWidth = rect.x1 - rect.x0;
+    rasterisedPixels += rectWidth * (rect.y1 - rect.y0);
+    PROFILE_COUNT("pixels rasterised", rectWidth * (rect.y1 - rect.y0));
+
+    {
+        PROFILE_SCOPE("rasterise");
+        for (int y = rect.y0; y < rect.y1; ++y) {
+            size_t cells = rect.offset + (size_t)(y - rect.y0) * rectWidth;
+            WorldChunk::toARGB(&capturedTypes[cells], &capturedColors[cells], rectWidth, &raster[y * width + rect.x0]);
+        }
+    }
+
+    // Glow from fire in the rectangle and the rows below it. Fire is rare, so each type row
+    // is searched with memchr.
+    PROFILE_SCOPE("fire glow");
+    for (int row = 0; row < rect.rows; ++row) {
+        const ParticleType* types = &capturedTypes[rect.offset + (size_t)row * rectWidth];
+        const void* fire = std::memchr(types, (int)ParticleType::FIRE, rectWidth);
+        while (fire) {
+            int offset = (int)(static_cast<const ParticleType*>(fire) - types);
+            ParticleColor color = capturedColors[rect.offset + (size_t)row * rectWidth + offset];
+            for (int up = 0; up <= World::FIRE_GLOW_HEIGHT; ++up) {
+                int y = rect.y0 + row - up;
+                if (y >= rect.y0 && y < rect.y1) addGlow(raster[y * width + rect.x0 + offset], color, up);
+            }
+            fire = std::memchr(types + offset + 1, (int)ParticleType::FIRE, rectWidth - offset - 1);
+        }
+    }
+}
+
+ViewportRenderer::Rect ViewportRenderer::tileRect(int tileIndex) const {
+    int worldX0 = (firstTileX + tileIndex % tilesX) * TILE;
+    int worldY0 = (firstTileY + tileIndex / tilesX) * TILE;
+    int x0 = std::max(worldX0 - lastLeft, 0);
+    int y0 = std::max(worldY0 - lastTop, 0);
+    int x1 = std::min(worldX0 + TILE - lastLeft, width);
+    int y1 = std::min(worldY0 + TILE - lastTop, height);
+    return {x0, y0, x1 - x0, y1 - y0};
+}
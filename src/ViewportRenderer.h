@@ -0,0 +1,100 @@
+#pragma once
+#include "SandSimulator.h"  // For ParticleType, ParticleColor
+#include <cstdint>
+#include <vector>
+
+class World;
+
+// Rasterises the visible part of the world into an ARGB8888 pixel buffer, redrawing only
+// what changed since the last frame.
+//
+// The renderer keeps the world raster (particles plus fire glow) between frames. When the
+// camera scrolls, the raster is shifted and only the newly exposed strips are drawn; when
+// it is still, only render tiles the world flagged dirty are redrawn. Ballistic particles
+// are drawn over the raster by render(), and callers draw further overlays (bullets) into
+// getPixels() after it; finishFrame() then restores the tiles overlays covered on the next
+// frame and reports which rectangles need uploading.
+//
+// render() is capture() followed by rasterise(). When another thread updates the world,
+// only capture() needs the world held: it copies the cells that changed, and rasterise()
+// draws from the copy.
+class ViewportRenderer {
+public:
+    // Region of the pixel buffer to upload
+    struct Rect {
+        int x, y, w, h;
+    };
+
+    ViewportRenderer(int width, int height);
+
+    // Bring the frame up to date for the width x height region whose top-left world cell
+    // is (left, top). Consumes the world's render-dirty flags for the visible tiles.
+    void render(World& world, int left, int top) {
+        capture(world, left, top);
+        rasterise();
+    }
+
+    // The two halves of render(): copy the cells to redraw and the particles in flight,
+    // then draw them without reading the world
+    void capture(World& world, int left, int top);
+    void rasterise();
+
+    // Call once overlays are drawn: the rectangles of getPixels() changed since the last
+    // finishFrame(), with adjacent tiles of a row merged
+    const std::vector<Rect>& finishFrame();
+
+    // Redraw everything on the next render()
+    void invalidate() { hasRaster = false; }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    std::vector<uint32_t>& getPixels() { return pixels; }
+    const std::vector<uint32_t>& getPixels() const { return pixels; }
+
+    // Work done by the last frame, in pixels
+    int getRasterisedPixels() const { return rasterisedPixels; }
+    int getUploadedPixels() const { return uploadedPixels; }
+
+private:
+    int width, height;
+    std::vector<uint32_t> raster;  // World only, persistent
+    std::vector<uint32_t> pixels;  // Raster plus overlays: what gets uploaded
+
+    bool hasRaster = false;
+    int lastLeft = 0, lastTop = 0;
+
+    // Render tiles covering the viewport this frame (world-aligned, edge tiles are partial)
+    int firstTileX = 0, firstTileY = 0;
+    int tilesX = 0, tilesY = 0;
+    std::vector<unsigned char> tileChanged;   // Raster redrawn or overlay restored this frame
+    std::vector<unsigned char> overlayTiles;  // Tiles overlays drew into last frame
+    bool fullUpload = false;
+    std::vector<Rect> uploadRects;
+
+    // Left by capture() for rasterise()
+    struct CapturedRect {
+        int x0, y0, x1, y1;  // Pixel rectangle to redraw
+        int rows;            // Rows captured: the rectangle's and the FIRE_GLOW_HEIGHT below it
+        size_t offset;       // First cell in capturedTypes / capturedColors, rows of x1 - x0
+    };
+    struct CapturedPixel {
+        int x, y;
+        uint32_t argb;
+    };
+    bool shiftPending = false;
+    bool scrolledPending = false;
+    int shiftX = 0, shiftY = 0;
+    std::vector<CapturedRect> capturedRects;
+    std::vector<ParticleType> capturedTypes;    // Grown as needed, never shrunk
+    std::vector<ParticleColor> capturedColors;
+    size_t capturedCells = 0;                   // In use this frame
+    std::vector<CapturedPixel> capturedBallistics;
+
+    int rasterisedPixels = 0;
+    int uploadedPixels = 0;
+
+    void shiftRaster(int dx, int dy);
+    void captureRect(const World& world, int left, int top, int x0, int y0, int x1, int y1);
+    void rasteriseRect(const CapturedRect& rect);
+    Rect tileRect(int tileIndex) const;  // Pixel-buffer rectangle of a visible tile
+};
@@ -1,6 +1,11 @@
 #include "World.h"
 #include "SandSimulator.h"
 #include "Texturize.h"
+#include "ChunkGenerator.h"
+#include "ScenePalette.h"
+#include "LevelFile.h"
+#include "Random.h"
+#include "Profiler.h"
 #include <cstdlib>
 #include <ctime>
 #include <cmath>
@@ -12,8 +17,14 @@
 #define STBI_MAX_DIMENSIONS 33554432
 #include "stb_image.h"
 
+// Keeps chunk generation streams apart from the per-tick simulation streams
+static constexpr uint64_t CHUNK_GENERATION_SALT = 0x6368756e6b000000ull;
+static constexpr uint64_t HEAT_SALT = 0x6865617400000000ull;
+static constexpr uint64_t EXPLOSION_SALT = 0x626c617374000000ull;
+
 World::World(const Config& cfg) : config(cfg) {
-    std::srand(std::time(nullptr));
+    worldSeed = config.worldSeed ? config.worldSeed : (uint64_t)std::time(nullptr);
+    Random::local().reseed(worldSeed);
 
     // Initialize camera at bottom-left of world
     camera.x = 0;
@@ -21,11 +32,30 @@ World::World(const Config& cfg) : config(cfg) {
     camera.moveSpeed = 25.0f;  // 25 pixels per second as requested
 
     // Initialize particle chunk system
-    particleChunks.resize(P_CHUNKS_X * P_CHUNKS_Y);
-    particleChunkActivity.resize(P_CHUNKS_X * P_CHUNKS_Y, false);
+    particleChunkStableFrames.resize(P_CHUNKS_X * P_CHUNKS_Y, 0);
+    simTileLastTick.resize(SIM_TILES_X * SIM_TILES_Y, 0);
+    initThermalProperties();
+
+    chunkTable.resize(WORLD_CHUNKS_X * WORLD_CHUNKS_Y, nullptr);
+    for (auto& total : particleTypeTotals) total.store(0, std::memory_order_relaxed);
+
+    if (config.chunkGenerationThreads > 0) {
+        chunkGenerator = std::make_unique<ChunkGenerator>(*this, config.chunkGenerationThreads);
+    }
+
+    if (config.persistDistantChunks) {
+        regionStore = std::make_unique<RegionStore>(config.regionCacheDir);
+        if (!regionStore->isOpen()) {
+            std::cerr << "Region cache unavailable - distant chunks stay in memory" << std::endl;
+            regionStore.reset();
+        }
+    }
 }
 
 World::~World() {
+    // Generation threads read the scene image - stop them first
+    chunkGenerator.reset();
+
     if (sceneImageData) {
         stbi_image_free(sceneImageData);
         sceneImageData = nullptr;
@@ -35,12 +65,17 @@ World::~World() {
 void World::moveCamera(float dx, float dy, float deltaTime) {
     float moveAmount = camera.moveSpeed * deltaTime;
 
+    float prevX = camera.x;
+    float prevY = camera.y;
+
     camera.x += dx * moveAmount;
     camera.y += dy * moveAmount;
 
     // Clamp to world bounds
     camera.x = std::max(0.0f, std::min(camera.x, (float)(WORLD_WIDTH - camera.viewportWidth)));
     camera.y = std::max(0.0f, std::min(camera.y, (float)(WORLD_HEIGHT - camera.viewportHeight)));
+
+    camera.trackVelocity(prevX, prevY, deltaTime);
 }
 
 // World coordinate conversions
@@ -73,31 +108,71 @@ WorldChunk* World::getChunk(int chunkX, int chunkY) {
         return nullptr;
     }
 
+    WorldChunk* existing = chunkTable[chunkY * WORLD_CHUNKS_X + chunkX];
+    if (existing) {
+        return existing;
+    }
+
     ChunkKey key{chunkX, chunkY};
-    auto it = chunks.find(key);
-    if (it != chunks.end()) {
-        return it->second.get();
+    std::vector<EnemySpawnPoint> spawnPoints;
+
+    // Chunk evicted earlier: restore it as it was, it has already been generated
+    if (regionStore && regionStore->contains(chunkX, chunkY)) {
+        auto restored = regionStore->load(chunkX, chunkY);
+        if (restored) {
+            return publishChunk(std::move(restored), false, spawnPoints);
+        }
     }
 
-    // Create new chunk on demand
-    auto chunk = std::make_unique<WorldChunk>(chunkX, chunkY);
+    // Create new chunk on demand. The caller needs it now, so generate it right here
+    // even if the background generator is already working on it.
+    bool populateFromScene = hasScene() && chunksPopulatedFromScene.find(key) == chunksPopulatedFromScene.end();
+    auto chunk = generateChunk(chunkX, chunkY, populateFromScene, spawnPoints);
+    return publishChunk(std::move(chunk), populateFromScene, spawnPoints);
+}
+
+WorldChunk* World::publishChunk(std::unique_ptr<WorldChunk> chunk, bool populatedFromScene,
+                                const std::vector<EnemySpawnPoint>& spawnPoints) {
+    ChunkKey key{chunk->getChunkX(), chunk->getChunkY()};
     WorldChunk* ptr = chunk.get();
+    ptr->attachTypeTotals(particleTypeTotals);
     chunks[key] = std::move(chunk);
+    chunkTable[key.y * WORLD_CHUNKS_X + key.x] = ptr;
+    markChunkRenderDirty(key.x, key.y);
 
-    // Populate from scene image if available and not already done
-    if (sceneImageData && chunksPopulatedFromScene.find(key) == chunksPopulatedFromScene.end()) {
-        populateChunkFromScene(ptr);
+    // Fresh terrain may not have settled: simulate it until it comes to rest
+    wakeMovableParticleChunks(*ptr);
+    initChunkTemperatures(*ptr);
+
+    if (populatedFromScene) {
         chunksPopulatedFromScene[key] = true;
     }
+    enemySpawnPoints.insert(enemySpawnPoints.end(), spawnPoints.begin(), spawnPoints.end());
+
+    return ptr;
+}
+
+std::unique_ptr<WorldChunk> World::generateChunk(int chunkX, int chunkY, bool populateFromScene,
+                                                 std::vector<EnemySpawnPoint>& spawnPoints) const {
+    // Same chunk, same contents, whichever thread builds it
+    Random::local().reseed(Random::hash(worldSeed, chunkX, chunkY, CHUNK_GENERATION_SALT));
+
+    auto chunk = std::make_unique<WorldChunk>(chunkX, chunkY);
+
+    // Populate from scene image if available and not already done
+    if (populateFromScene) {
+        populateChunkFromScene(chunk.get(), spawnPoints);
+    }
 
-    procedurallyGenerateMoss(ptr);
+    ChunkCanvas canvas(*this, *chunk);
+    procedurallyGenerateMoss(canvas);
     Texturize texturizer;
 
     // Apply rock texture
-    texturizer.applyBrickTexture(this, ptr);
+    texturizer.applyBrickTexture(canvas);
 
     // Apply rock borders (gradient + pattern on edges)
-    texturizer.applyRockBorders(this, ptr);
+    texturizer.applyRockBorders(canvas);
 
     // Apply inner rock texture for ROCK
     TextureParams rockParams;
@@ -107,7 +182,7 @@ WorldChunk* World::getChunk(int chunkX, int chunkY) {
     rockParams.minPatchRadius = config.rock.innerRockMinRadius;
     rockParams.maxPatchRadius = config.rock.innerRockMaxRadius;
     rockParams.colorMultiplier = config.rock.innerRockDarkness;
-    texturizer.apply(this, ptr, ParticleType::ROCK, rockParams);
+    texturizer.apply(canvas, ParticleType::ROCK, rockParams);
 
     // Apply obsidian texture
     TextureParams obsidianParams;
@@ -117,16 +192,22 @@ WorldChunk* World::getChunk(int chunkX, int chunkY) {
     obsidianParams.minPatchRadius = config.obsidian.innerRockMinRadius;
     obsidianParams.maxPatchRadius = config.obsidian.innerRockMaxRadius;
     obsidianParams.colorMultiplier = config.obsidian.innerRockDarkness;
-    texturizer.apply(this, ptr, ParticleType::OBSIDIAN, obsidianParams);
+    texturizer.apply(canvas, ParticleType::OBSIDIAN, obsidianParams);
 
     // Apply obsidian borders (gradient + pattern on edges)
-    texturizer.applyObsidianBorders(this, ptr);
+    texturizer.applyObsidianBorders(canvas);
 
-    return ptr;
+    return chunk;
 }
 
 bool World::setSceneImage(const std::string& filepath) {
-    // Free existing image if any
+    // Chunks being generated read the old image
+    if (chunkGenerator) {
+        chunkGenerator->cancelAll();
+    }
+
+    // Free existing scene if any
+    sceneLevel.reset();
     if (sceneImageData) {
         stbi_image_free(sceneImageData);
         sceneImageData = nullptr;
@@ -145,82 +226,70 @@ bool World::setSceneImage(const std::string& filepath) {
     std::cout << "Image covers world Y range: " << (WORLD_HEIGHT - sceneImageHeight) << " to " << WORLD_HEIGHT << std::endl;
     std::cout << "Image covers world X range: 0 to " << sceneImageWidth << std::endl;
 
+    if (!scenePalette) {
+        scenePalette = std::make_unique<ScenePalette>(ScenePalette::SCENE_DARK_CUTOFF, ScenePalette::SCENE_MATCH_THRESHOLD);
+    }
+
     // Clear the populated tracking so chunks can be repopulated
     chunksPopulatedFromScene.clear();
 
     return true;
 }
 
-void World::populateChunkFromScene(WorldChunk* chunk) {
-    if (!sceneImageData || !chunk) return;
-
-    int chunkWorldX = chunk->getWorldX();
-    int chunkWorldY = chunk->getWorldY();
-
-    // The image is placed at bottom-left of world
-    // Image Y=0 corresponds to world Y = WORLD_HEIGHT - sceneImageHeight
-    int imageBaseY = WORLD_HEIGHT - sceneImageHeight;
-
-    // Color mappings
-    struct ColorMapping {
-        int r, g, b;
-        ParticleType type;
-    };
-
-    std::vector<ColorMapping> colorMap = {
-        // Sand variants
-        {255, 200, 100, ParticleType::SAND},
-        {194, 178, 128, ParticleType::SAND},  // Tan sand
-
-        // Water variants - multiple blues
-        {50, 100, 255, ParticleType::WATER},
-        {0, 0, 255, ParticleType::WATER},      // Pure blue
-        {0, 100, 255, ParticleType::WATER},    // Azure
-        {50, 150, 255, ParticleType::WATER},   // Light blue
-        {64, 164, 223, ParticleType::WATER},   // Sky blue
+bool World::setSceneLevel(const std::string& filepath) {
+    if (chunkGenerator) {
+        chunkGenerator->cancelAll();
+    }
 
-        // Rock
-        {128, 128, 128, ParticleType::ROCK},
-        {100, 100, 100, ParticleType::ROCK},   // Darker gray
-        {150, 150, 150, ParticleType::ROCK},   // Lighter gray
+    if (sceneImageData) {
+        stbi_image_free(sceneImageData);
+        sceneImageData = nullptr;
+    }
 
-        // Lava
-        {255, 100, 0, ParticleType::LAVA},
-        {255, 69, 0, ParticleType::LAVA},      // Orange-red
+    sceneLevel = std::make_unique<LevelFile>();
+    if (!sceneLevel->open(filepath)) {
+        sceneLevel.reset();
+        return false;
+    }
 
-        // Steam
-        {240, 240, 240, ParticleType::STEAM},
-        {255, 255, 255, ParticleType::STEAM},  // Pure white
+    chunksPopulatedFromScene.clear();
+    return true;
+}
 
-        // Obsidian
-        {30, 20, 40, ParticleType::OBSIDIAN},
+ParticleType World::getSceneParticle(int worldX, int worldY) const {
+    if (sceneLevel) return sceneLevel->getParticle(worldX, worldY);
+    if (!sceneImageData) return ParticleType::EMPTY;
 
-        // Fire
-        {255, 50, 0, ParticleType::FIRE},
-        {255, 0, 0, ParticleType::FIRE},       // Pure red
+    // The image is placed at bottom-left of world
+    int imageX = worldX;
+    int imageY = worldY - (WORLD_HEIGHT - sceneImageHeight);
+    if (imageX < 0 || imageX >= sceneImageWidth || imageY < 0 || imageY >= sceneImageHeight) {
+        return ParticleType::EMPTY;
+    }
 
-        // Ice
-        {200, 230, 255, ParticleType::ICE},
+    int pixelIdx = (imageY * sceneImageWidth + imageX) * 3;
+    int r = sceneImageData[pixelIdx];
+    int g = sceneImageData[pixelIdx + 1];
+    int b = sceneImageData[pixelIdx + 2];
 
-        // Glass
-        {100, 180, 180, ParticleType::GLASS},
-        {0, 255, 255, ParticleType::GLASS},    // Cyan
+    unsigned char match = scenePalette->classify(r, g, b);
+    return match == ScenePalette::JUMPER_MARKER ? ParticleType::EMPTY : (ParticleType)match;
+}
 
-        // Wood
-        {139, 90, 43, ParticleType::WOOD},
-        {139, 69, 19, ParticleType::WOOD},      // Saddle brown
+void World::populateChunkFromScene(WorldChunk* chunk, std::vector<EnemySpawnPoint>& spawnPoints) const {
+    if (sceneLevel) {
+        populateChunkFromLevel(chunk, spawnPoints);
+        return;
+    }
+    if (!sceneImageData || !chunk) return;
 
-        // Moss
-        {0, 150, 0, ParticleType::MOSS},
-        {20, 130, 20, ParticleType::MOSS}
-    };
+    int chunkWorldX = chunk->getWorldX();
+    int chunkWorldY = chunk->getWorldY();
 
-    auto colorDistance = [](int r1, int g1, int b1, int r2, int g2, int b2) {
-        return (r1 - r2) * (r1 - r2) + (g1 - g2) * (g1 - g2) + (b1 - b2) * (b1 - b2);
-    };
+    // The image is placed at bottom-left of world
+    // Image Y=0 corresponds to world Y = WORLD_HEIGHT - sceneImageHeight
+    int imageBaseY = WORLD_HEIGHT - sceneImageHeight;
 
-    // Threshold for color matching - reject blended/anti-aliased pixels
-    int threshold = 3500;
     int particlesLoaded = 0;
 
     for (int localY = 0; localY < WorldChunk::CHUNK_SIZE; localY++) {
@@ -242,77 +311,24 @@ void World::populateChunkFromScene(WorldChunk* chunk) {
             int g = sceneImageData[pixelIdx + 1];
             int b = sceneImageData[pixelIdx + 2];
 
-            // Skip dark pixels (empty/background) - be more aggressive
-            if (r < 30 && g < 30 && b < 30) continue;
-
-            // Check for enemy spawn markers FIRST (before particle matching)
-            // #450981 = RGB(69, 9, 129) - Little Purple Jumper
-            int markerDist = colorDistance(r, g, b, 69, 9, 129);
-            if (markerDist < 500) {  // Tight threshold for exact marker match
+            unsigned char match = scenePalette->classify(r, g, b);
+            if (match == ScenePalette::JUMPER_MARKER) {
                 EnemySpawnPoint spawn;
                 spawn.worldX = worldX;
                 spawn.worldY = worldY;
                 spawn.type = SpawnMarkerType::LITTLE_PURPLE_JUMPER;
                 spawn.spawned = false;
-                enemySpawnPoints.push_back(spawn);
+                spawnPoints.push_back(spawn);
                 continue;  // Don't create a particle here
             }
 
-            ParticleType bestMatch = ParticleType::EMPTY;
-            int bestDist = threshold;
-
-            for (const auto& cm : colorMap) {
-                int dist = colorDistance(r, g, b, cm.r, cm.g, cm.b);
-                if (dist < bestDist) {
-                    bestDist = dist;
-                    bestMatch = cm.type;
-                }
-            }
+            ParticleType bestMatch = (ParticleType)match;
 
             if (bestMatch != ParticleType::EMPTY) {
                 // Set particle directly in chunk
                 chunk->setParticle(localX, localY, bestMatch);
 
-                // Set color
-                ParticleColor color;
-                switch (bestMatch) {
-                    case ParticleType::SAND:
-                        color = generateRandomColor(config.sand.colorR, config.sand.colorG, config.sand.colorB, config.sand.colorVariation);
-                        break;
-                    case ParticleType::WATER:
-                        color = generateRandomColor(config.water.colorR, config.water.colorG, config.water.colorB, config.water.colorVariation);
-                        break;
-                    case ParticleType::ROCK:
-                        color = generateRandomColor(config.rock.colorR, config.rock.colorG, config.rock.colorB, config.rock.colorVariation);
-                        break;
-                    case ParticleType::LAVA:
-                        color = generateRandomColor(config.lava.colorR, config.lava.colorG, config.lava.colorB, config.lava.colorVariation);
-                        break;
-                    case ParticleType::STEAM:
-                        color = generateRandomColor(config.steam.colorR, config.steam.colorG, config.steam.colorB, config.steam.colorVariation);
-                        break;
-                    case ParticleType::FIRE:
-                        color = generateRandomColor(config.fire.colorR, config.fire.colorG, config.fire.colorB, config.fire.colorVariation);
-                        break;
-                    case ParticleType::ICE:
-                        color = generateRandomColor(config.ice.colorR, config.ice.colorG, config.ice.colorB, config.ice.colorVariation);
-                        break;
-                    case ParticleType::GLASS:
-                        color = generateRandomColor(config.glass.colorR, config.glass.colorG, config.glass.colorB, config.glass.colorVariation);
-                        break;
-                    case ParticleType::WOOD:
-                        color = generateRandomColor(config.wood.colorR, config.wood.colorG, config.wood.colorB, config.wood.colorVariation);
-                        break;
-                    case ParticleType::OBSIDIAN:
-                        color = generateRandomColor(config.obsidian.colorR, config.obsidian.colorG, config.obsidian.colorB, config.obsidian.colorVariation);
-                        break;
-                    case ParticleType::MOSS:
-                        color = generateRandomColor(config.moss.colorR, config.moss.colorG, config.moss.colorB, config.moss.colorVariation);
-                        break;
-                    default:
-                        color = {128, 128, 128};
-                }
-                chunk->setColor(localX, localY, color);
+                chunk->setColor(localX, localY, randomParticleColor(bestMatch));
 
                 // Mark as settled so physics colliders work
                 chunk->setSettled(localX, localY, true);
@@ -328,17 +344,42 @@ void World::populateChunkFromScene(WorldChunk* chunk) {
     }
 }
 
-const WorldChunk* World::getChunk(int chunkX, int chunkY) const {
-    if (chunkX < 0 || chunkX >= WORLD_CHUNKS_X || chunkY < 0 || chunkY >= WORLD_CHUNKS_Y) {
-        return nullptr;
+void World::populateChunkFromLevel(WorldChunk* chunk, std::vector<EnemySpawnPoint>& spawnPoints) const {
+    if (!chunk) return;
+
+    int markerCount;
+    const LevelFile::Marker* markers = sceneLevel->getTileMarkers(chunk->getChunkX(), chunk->getChunkY(), markerCount);
+    for (int i = 0; i < markerCount; i++) {
+        EnemySpawnPoint spawn;
+        spawn.worldX = chunk->getWorldX() + markers[i].localX;
+        spawn.worldY = chunk->getWorldY() + markers[i].localY;
+        spawn.type = (SpawnMarkerType)markers[i].type;
+        spawn.spawned = false;
+        spawnPoints.push_back(spawn);
     }
 
-    ChunkKey key{chunkX, chunkY};
-    auto it = chunks.find(key);
-    if (it != chunks.end()) {
-        return it->second.get();
+    // Cells are already classified; a tile without cell data is a single type throughout
+    ParticleType fillType;
+    const unsigned char* types = sceneLevel->getTileTypes(chunk->getChunkX(), chunk->getChunkY(), fillType);
+    if (!types && fillType == ParticleType::EMPTY) return;
+
+    for (int localY = 0; localY < WorldChunk::CHUNK_SIZE; localY++) {
+        for (int localX = 0; localX < WorldChunk::CHUNK_SIZE; localX++) {
+            ParticleType type = types ? (ParticleType)types[localY * WorldChunk::CHUNK_SIZE + localX] : fillType;
+            if (type == ParticleType::EMPTY) continue;
+
+            chunk->setParticle(localX, localY, type);
+            chunk->setColor(localX, localY, randomParticleColor(type));
+            chunk->setSettled(localX, localY, true);  // So physics colliders work
+        }
     }
-    return nullptr;
+
+    chunk->setActive(true);
+    chunk->setSleeping(false);
+}
+
+const WorldChunk* World::getChunk(int chunkX, int chunkY) const {
+    return findChunk(chunkX, chunkY);
 }
 
 WorldChunk* World::getChunkAtWorldPos(int worldX, int worldY) {
@@ -348,9 +389,17 @@ WorldChunk* World::getChunkAtWorldPos(int worldX, int worldY) {
 }
 
 const WorldChunk* World::getChunkAtWorldPos(int worldX, int worldY) const {
-    int chunkX, chunkY;
-    worldToChunk(worldX, worldY, chunkX, chunkY);
-    return getChunk(chunkX, chunkY);
+    return findChunkAtWorldPos(worldX, worldY);
+}
+
+void World::getChunkNeighborhood(int chunkX, int chunkY, ChunkNeighborhood& out) const {
+    out.originChunkX = chunkX;
+    out.originChunkY = chunkY;
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            out.chunks[dy + 1][dx + 1] = findChunk(chunkX + dx, chunkY + dy);
+        }
+    }
 }
 
 ParticleType World::getParticle(int worldX, int worldY) const {
@@ -373,6 +422,8 @@ void World::setParticle(int worldX, int worldY, ParticleType type) {
     int localX, localY;
     worldToLocal(worldX, worldY, localX, localY);
     chunk->setParticle(localX, localY, type);
+    chunk->setUpdateParity(localX, localY, frameParity);  // Not yet updated by the next sweep
+    markRenderDirty(worldX, worldY);
 }
 
 ParticleColor World::getColor(int worldX, int worldY) const {
@@ -395,6 +446,7 @@ void World::setColor(int worldX, int worldY, ParticleColor color) {
     int localX, localY;
     worldToLocal(worldX, worldY, localX, localY);
     chunk->setColor(localX, localY, color);
+    markRenderDirty(worldX, worldY);
 }
 
 bool World::isOccupied(int worldX, int worldY) const {
@@ -460,11 +512,11 @@ static ParticleColor hslToRgb(double h, double s, double l) {
     };
 }
 
-ParticleColor World::generateRandomColor(int baseR, int baseG, int baseB, int variation) {
+ParticleColor World::generateRandomColor(int baseR, int baseG, int baseB, int variation) const {
     if (variation > 0) {
         HSL hsl = rgbToHsl(baseR, baseG, baseB);
 
-        double random_scalar = ((double)std::rand() / RAND_MAX) * 2.0 - 1.0;
+        double random_scalar = Random::local().uniform() * 2.0 - 1.0;
 
         double lightness_variation = (double)variation / 255.0;
         hsl.l += random_scalar * lightness_variation;
@@ -477,19 +529,7 @@ ParticleColor World::generateRandomColor(int baseR, int baseG, int baseB, int va
     }
 }
 
-void World::spawnParticleAt(int worldX, int worldY, ParticleType type) {
-    if (!inWorldBounds(worldX, worldY)) return;
-    if (isOccupied(worldX, worldY)) return;
-
-    WorldChunk* chunk = getChunkAtWorldPos(worldX, worldY);
-    if (!chunk) return;
-
-    int localX, localY;
-    worldToLocal(worldX, worldY, localX, localY);
-
-    chunk->setParticle(localX, localY, type);
-
-    // Set color based on type
+ParticleColor World::randomParticleColor(ParticleType type) const {
     ParticleColor color;
     switch (type) {
         case ParticleType::SAND:
@@ -528,41 +568,154 @@ void World::spawnParticleAt(int worldX, int worldY, ParticleType type) {
         default:
             color = {128, 128, 128};
     }
-    chunk->setColor(localX, localY, color);
+    return color;
+}
+
+void World::spawnParticleAt(int worldX, int worldY, ParticleType type) {
+    if (!inWorldBounds(worldX, worldY)) return;
+    if (isOccupied(worldX, worldY)) return;
+
+    WorldChunk* chunk = getChunkAtWorldPos(worldX, worldY);
+    if (!chunk) return;
+
+    int localX, localY;
+    worldToLocal(worldX, worldY, localX, localY);
+
+    chunk->setParticle(localX, localY, type);
+
+    chunk->setColor(localX, localY, randomParticleColor(type));
     chunk->setSettled(localX, localY, false);
+    chunk->setUpdateParity(localX, localY, frameParity);
+    markRenderDirty(worldX, worldY);
 
+    float temperature = thermal[(int)type].startTemperature;
+    chunk->setTemperature(localX, localY, temperature);
+    if (!isAmbient(temperature)) markWarm(worldX, worldY);
 
     // Wake world chunk
     wakeChunkAtWorldPos(worldX, worldY);
 
-    // Wake particle chunk - set isAwake directly, not just activity flag
+    // Wake particle chunk directly, not just through the activity flag
     int pcX, pcY;
     worldToParticleChunk(worldX, worldY, pcX, pcY);
-    int pcIndex = pcY * P_CHUNKS_X + pcX;
-    if (pcIndex >= 0 && pcIndex < (int)particleChunks.size()) {
-        particleChunks[pcIndex].isAwake = true;
-        particleChunks[pcIndex].stableFrames = 0;
-    }
+    wakeParticleChunks(pcX, pcY, pcX, pcY);
 }
 
 void World::loadChunksAroundCamera() {
+    PROFILE_SCOPE("chunk loading");
     int centerChunkX = (int)(camera.x + camera.viewportWidth / 2) / WorldChunk::CHUNK_SIZE;
     int centerChunkY = (int)(camera.y + camera.viewportHeight / 2) / WorldChunk::CHUNK_SIZE;
 
-    // Load chunks within radius
-    for (int dy = -LOAD_RADIUS; dy <= LOAD_RADIUS; dy++) {
-        for (int dx = -LOAD_RADIUS; dx <= LOAD_RADIUS; dx++) {
+    // Publish chunks the generator finished since the last call
+    if (chunkGenerator) {
+        generatedChunks.clear();
+        chunkGenerator->collect(generatedChunks);
+
+        for (auto& result : generatedChunks) {
+            int cx = result.chunk->getChunkX();
+            int cy = result.chunk->getChunkY();
+
+            // Already created synchronously, or the camera has moved away again
+            if (findChunk(cx, cy)) continue;
+            if (std::abs(cx - centerChunkX) > LOAD_RADIUS + 2 || std::abs(cy - centerChunkY) > LOAD_RADIUS + 2) continue;
+
+            publishChunk(std::move(result.chunk), result.populatedFromScene, result.spawnPoints);
+        }
+    }
+
+    // Chunks under the viewport (plus the reach of the simulation border) are needed this
+    // frame and are created synchronously; the rest of the ring is generated in the background
+    int visStartX, visStartY, visEndX, visEndY;
+    getVisibleRegion(visStartX, visStartY, visEndX, visEndY);
+    int needStartX, needStartY, needEndX, needEndY;
+    worldToChunk(std::max(0, visStartX - SIM_TILE_SIZE), std::max(0, visStartY - SIM_TILE_SIZE), needStartX, needStartY);
+    worldToChunk(std::min(WORLD_WIDTH - 1, visEndX + SIM_TILE_SIZE), std::min(WORLD_HEIGHT - 1, visEndY + SIM_TILE_SIZE), needEndX, needEndY);
+
+    // Chunks within LOAD_RADIUS are always loaded; with a generator, chunks up to PREFETCH_RADIUS
+    // are also generated early if the camera will reach them within the prefetch budget.
+    // Generator priority is the time to arrival; chunks not being approached follow nearest
+    // first, and chunks the camera is leaving go last (or are not generated at all if they
+    // are more than one ring away).
+    if (chunkGenerator) chunkGenerator->beginRequests();
+    int radius = chunkGenerator ? PREFETCH_RADIUS : LOAD_RADIUS;
+
+    for (int dy = -radius; dy <= radius; dy++) {
+        for (int dx = -radius; dx <= radius; dx++) {
+            int ring = std::max(std::abs(dx), std::abs(dy));
             int cx = centerChunkX + dx;
             int cy = centerChunkY + dy;
 
-            if (cx >= 0 && cx < WORLD_CHUNKS_X && cy >= 0 && cy < WORLD_CHUNKS_Y) {
+            if (cx < 0 || cx >= WORLD_CHUNKS_X || cy < 0 || cy >= WORLD_CHUNKS_Y) continue;
+            if (findChunk(cx, cy)) continue;
+
+            bool needed = cx >= needStartX && cx <= needEndX && cy >= needStartY && cy <= needEndY;
+            if (needed || !chunkGenerator) {
                 getChunk(cx, cy);  // Creates chunk if not exists
+                continue;
+            }
+
+            bool receding = false;
+            float arrival = chunkArrivalTime(cx, cy, receding);
+            if (ring > LOAD_RADIUS && arrival > config.chunkPrefetchSeconds) continue;
+            if (receding && ring > 1) continue;
+
+            if (regionStore && regionStore->contains(cx, cy)) {
+                getChunk(cx, cy);  // Restoring is cheap, no need to queue it
+                continue;
             }
+
+            float priority = std::isinf(arrival) ? 1000.0f + ring : arrival;
+            if (receding) priority += 1000.0f;
+
+            ChunkKey key{cx, cy};
+            bool populateFromScene = hasScene() && chunksPopulatedFromScene.find(key) == chunksPopulatedFromScene.end();
+            chunkGenerator->request(cx, cy, populateFromScene, priority);
         }
     }
 }
 
+// Below this speed the camera counts as standing still on that axis
+static constexpr float PREFETCH_MIN_SPEED = 20.0f;
+
+// Time for the span [viewMin, viewMax] moving at velocity to overlap [chunkMin, chunkMax]
+static float axisArrivalTime(float viewMin, float viewMax, float chunkMin, float chunkMax, float velocity, bool& receding) {
+    if (std::abs(velocity) < PREFETCH_MIN_SPEED) velocity = 0.0f;
+
+    float gap;
+    if (chunkMax < viewMin) {
+        gap = viewMin - chunkMax;
+        velocity = -velocity;
+    } else if (chunkMin > viewMax) {
+        gap = chunkMin - viewMax;
+    } else {
+        return 0.0f;
+    }
+
+    if (velocity < 0.0f) receding = true;
+    return velocity > 0.0f ? gap / velocity : INFINITY;
+}
+
+float World::chunkArrivalTime(int chunkX, int chunkY, bool& receding) const {
+    // The region a chunk must be loaded for: the viewport plus the simulation border,
+    // stretched towards the look-ahead the camera is heading for
+    float viewMinX = camera.x - SIM_TILE_SIZE + std::min(0.0f, camera.lookAheadX);
+    float viewMaxX = camera.x + camera.viewportWidth + SIM_TILE_SIZE + std::max(0.0f, camera.lookAheadX);
+    float viewMinY = camera.y - SIM_TILE_SIZE + std::min(0.0f, camera.lookAheadY);
+    float viewMaxY = camera.y + camera.viewportHeight + SIM_TILE_SIZE + std::max(0.0f, camera.lookAheadY);
+
+    float chunkMinX = (float)chunkX * WorldChunk::CHUNK_SIZE;
+    float chunkMinY = (float)chunkY * WorldChunk::CHUNK_SIZE;
+    float chunkMaxX = chunkMinX + WorldChunk::CHUNK_SIZE;
+    float chunkMaxY = chunkMinY + WorldChunk::CHUNK_SIZE;
+
+    receding = false;
+    float timeX = axisArrivalTime(viewMinX, viewMaxX, chunkMinX, chunkMaxX, camera.velocityX, receding);
+    float timeY = axisArrivalTime(viewMinY, viewMaxY, chunkMinY, chunkMaxY, camera.velocityY, receding);
+    return std::max(timeX, timeY);  // Both axes have to overlap
+}
+
 void World::unloadDistantChunks() {
+    PROFILE_SCOPE("chunk unloading");
     int centerChunkX = (int)(camera.x + camera.viewportWidth / 2) / WorldChunk::CHUNK_SIZE;
     int centerChunkY = (int)(camera.y + camera.viewportHeight / 2) / WorldChunk::CHUNK_SIZE;
 
@@ -573,16 +726,28 @@ void World::unloadDistantChunks() {
         int distX = std::abs(key.x - centerChunkX);
         int distY = std::abs(key.y - centerChunkY);
 
-        // Unload if far from camera and empty
+        // Unload if far from camera. Non-empty chunks can only go if there is a region cache.
         if (distX > LOAD_RADIUS + 2 || distY > LOAD_RADIUS + 2) {
-            if (chunk->isEmpty()) {
+            if (chunk->isEmpty() || regionStore) {
                 toRemove.push_back(key);
             }
         }
     }
 
     for (const auto& key : toRemove) {
-        chunks.erase(key);
+        chunkTable[key.y * WORLD_CHUNKS_X + key.x] = nullptr;
+        markChunkRenderDirty(key.x, key.y);
+
+        auto it = chunks.find(key);
+        it->second->detachTypeTotals();
+        if (regionStore) {
+            if (it->second->isEmpty()) {
+                regionStore->discard(key.x, key.y);  // Don't restore an older, non-empty copy
+            } else {
+                regionStore->save(std::move(it->second));
+            }
+        }
+        chunks.erase(it);
     }
 }
 
@@ -607,8 +772,8 @@ bool World::canMoveTo(int worldX, int worldY) const {
 void World::moveParticle(int fromX, int fromY, int toX, int toY) {
     if (!inWorldBounds(fromX, fromY) || !inWorldBounds(toX, toY)) return;
 
-    WorldChunk* fromChunk = getChunkAtWorldPos(fromX, fromY);
-    WorldChunk* toChunk = getChunkAtWorldPos(toX, toY);
+    WorldChunk* fromChunk = findChunkAtWorldPos(fromX, fromY);
+    WorldChunk* toChunk = findChunkAtWorldPos(toX, toY);
 
     if (!fromChunk || !toChunk) return;
 
@@ -622,18 +787,28 @@ void World::moveParticle(int fromX, int fromY, int toX, int toY) {
     ParticleVelocity vel = fromChunk->getVelocity(fromLocalX, fromLocalY);
     float temp = fromChunk->getTemperature(fromLocalX, fromLocalY);
 
+    // Move the type (inside one chunk this leaves the type counts alone)
+    if (fromChunk == toChunk) {
+        fromChunk->moveParticle(fromLocalX, fromLocalY, toLocalX, toLocalY);
+    } else {
+        fromChunk->setParticle(fromLocalX, fromLocalY, ParticleType::EMPTY);
+        toChunk->setParticle(toLocalX, toLocalY, type);
+    }
+
     // Clear source
-    fromChunk->setParticle(fromLocalX, fromLocalY, ParticleType::EMPTY);
     fromChunk->setColor(fromLocalX, fromLocalY, {0, 0, 0});
     fromChunk->setVelocity(fromLocalX, fromLocalY, {0, 0});
 
     // Set destination
-    toChunk->setParticle(toLocalX, toLocalY, type);
     toChunk->setColor(toLocalX, toLocalY, color);
     toChunk->setVelocity(toLocalX, toLocalY, vel);
     toChunk->setTemperature(toLocalX, toLocalY, temp);
     toChunk->setSettled(toLocalX, toLocalY, false);
-    toChunk->setMovedThisFrame(toLocalX, toLocalY, true);
+    toChunk->setUpdateParity(toLocalX, toLocalY, frameParity);
+    if (!isAmbient(temp)) markWarm(toX, toY);
+
+    markRenderDirty(fromX, fromY);
+    markRenderDirty(toX, toY);
 
     // Wake world chunks
     wakeChunkAtWorldPos(fromX, fromY);
@@ -642,16 +817,16 @@ void World::moveParticle(int fromX, int fromY, int toX, int toY) {
     // Wake particle chunks
     int pcX, pcY;
     worldToParticleChunk(fromX, fromY, pcX, pcY);
-    particleChunkActivity[pcY * P_CHUNKS_X + pcX] = true;
+    particleChunkActivity.set(pcX, pcY);
     worldToParticleChunk(toX, toY, pcX, pcY);
-    particleChunkActivity[pcY * P_CHUNKS_X + pcX] = true;
+    particleChunkActivity.set(pcX, pcY);
 }
 
 void World::swapParticles(int x1, int y1, int x2, int y2) {
     if (!inWorldBounds(x1, y1) || !inWorldBounds(x2, y2)) return;
 
-    WorldChunk* chunk1 = getChunkAtWorldPos(x1, y1);
-    WorldChunk* chunk2 = getChunkAtWorldPos(x2, y2);
+    WorldChunk* chunk1 = findChunkAtWorldPos(x1, y1);
+    WorldChunk* chunk2 = findChunkAtWorldPos(x2, y2);
 
     if (!chunk1 || !chunk2) return;
 
@@ -663,24 +838,39 @@ void World::swapParticles(int x1, int y1, int x2, int y2) {
     ParticleType type1 = chunk1->getParticle(local1X, local1Y);
     ParticleColor color1 = chunk1->getColor(local1X, local1Y);
     ParticleVelocity vel1 = chunk1->getVelocity(local1X, local1Y);
+    float temp1 = chunk1->getTemperature(local1X, local1Y);
 
     ParticleType type2 = chunk2->getParticle(local2X, local2Y);
     ParticleColor color2 = chunk2->getColor(local2X, local2Y);
     ParticleVelocity vel2 = chunk2->getVelocity(local2X, local2Y);
+    float temp2 = chunk2->getTemperature(local2X, local2Y);
 
     // Swap
-    chunk1->setParticle(local1X, local1Y, type2);
+    if (chunk1 == chunk2) {
+        chunk1->swapParticles(local1X, local1Y, local2X, local2Y);
+    } else {
+        chunk1->setParticle(local1X, local1Y, type2);
+        chunk2->setParticle(local2X, local2Y, type1);
+    }
     chunk1->setColor(local1X, local1Y, color2);
     chunk1->setVelocity(local1X, local1Y, vel2);
-    chunk1->setMovedThisFrame(local1X, local1Y, true);
+    chunk1->setTemperature(local1X, local1Y, temp2);
+    chunk1->setUpdateParity(local1X, local1Y, frameParity);
     chunk1->setSettled(local1X, local1Y, false);
 
-    chunk2->setParticle(local2X, local2Y, type1);
     chunk2->setColor(local2X, local2Y, color1);
     chunk2->setVelocity(local2X, local2Y, vel1);
-    chunk2->setMovedThisFrame(local2X, local2Y, true);
+    chunk2->setTemperature(local2X, local2Y, temp1);
+    chunk2->setUpdateParity(local2X, local2Y, frameParity);
     chunk2->setSettled(local2X, local2Y, false);
 
+    // Temperature travels with the particle, so both cells may now be warm
+    if (!isAmbient(temp2)) markWarm(x1, y1);
+    if (!isAmbient(temp1)) markWarm(x2, y2);
+
+    markRenderDirty(x1, y1);
+    markRenderDirty(x2, y2);
+
     // Wake world chunks
     wakeChunkAtWorldPos(x1, y1);
     wakeChunkAtWorldPos(x2, y2);
@@ -688,13 +878,45 @@ void World::swapParticles(int x1, int y1, int x2, int y2) {
     // Wake particle chunks
     int pcX, pcY;
     worldToParticleChunk(x1, y1, pcX, pcY);
-    particleChunkActivity[pcY * P_CHUNKS_X + pcX] = true;
+    particleChunkActivity.set(pcX, pcY);
     worldToParticleChunk(x2, y2, pcX, pcY);
-    particleChunkActivity[pcY * P_CHUNKS_X + pcX] = true;
+    particleChunkActivity.set(pcX, pcY);
+}
+
+void World::dropFallingRun(WorldChunk* chunk, int worldX, int worldY, int count) {
+    int localX, localY;
+    worldToLocal(worldX, worldY, localX, localY);
+    chunk->dropRun(localX, localY, count, frameParity);
+
+    // A run is narrower than a render tile, so its two ends cover every tile it touches
+    int lastX = worldX + count - 1;
+    markRenderDirty(worldX, worldY);
+    markRenderDirty(lastX, worldY);
+    markRenderDirty(worldX, worldY + 1);
+    markRenderDirty(lastX, worldY + 1);
+
+    // Hot or cold particles carry their temperature into the row below
+    if (const float* temperatures = chunk->getTemperatureValues()) {
+        const float* moved = temperatures + (localY + 1) * WorldChunk::CHUNK_SIZE + localX;
+        if (std::any_of(moved, moved + count, [](float t) { return !isAmbient(t); })) {
+            markWarm(worldX, worldY + 1);
+            markWarm(lastX, worldY + 1);
+        }
+    }
+
+    chunk->setSleeping(false);
+    chunk->setActive(true);
+    chunk->resetStableFrames();
+
+    int pcX, pcY;
+    worldToParticleChunk(worldX, worldY, pcX, pcY);
+    particleChunkActivity.set(pcX, pcY);
+    worldToParticleChunk(worldX, worldY + 1, pcX, pcY);
+    particleChunkActivity.set(pcX, pcY);
 }
 
 void World::wakeChunkAtWorldPos(int worldX, int worldY) {
-    WorldChunk* chunk = getChunkAtWorldPos(worldX, worldY);
+    WorldChunk* chunk = findChunkAtWorldPos(worldX, worldY);
     if (chunk) {
         chunk->setSleeping(false);
         chunk->setActive(true);
@@ -702,12 +924,28 @@ void World::wakeChunkAtWorldPos(int worldX, int worldY) {
     }
 }
 
+void World::markChunkRenderDirty(int chunkX, int chunkY) {
+    constexpr int TILES_PER_CHUNK = WorldChunk::CHUNK_SIZE / RENDER_TILE_SIZE;
+
+    // Include the tile row above: it holds the glow of fire in the chunk's top cells
+    renderDirty.fill(chunkX * TILES_PER_CHUNK, chunkY * TILES_PER_CHUNK - 1,
+                     (chunkX + 1) * TILES_PER_CHUNK - 1, (chunkY + 1) * TILES_PER_CHUNK - 1, true);
+}
+
 // Helper to mark a particle as settled
 void World::markSettled(int x, int y, bool settled) {
-    WorldChunk* chunk = getChunkAtWorldPos(x, y);
+    WorldChunk* chunk = findChunkAtWorldPos(x, y);
     if (!chunk) return;
     int localX, localY;
     worldToLocal(x, y, localX, localY);
+
+    // Water coming to rest: look there for new wetness contacts. Absorbent particles sinking
+    // into water displace it, so the water settles again next to them.
+    if (settled && !chunk->isSettled(localX, localY) && chunk->getParticle(localX, localY) == ParticleType::WATER) {
+        int pcX, pcY;
+        worldToParticleChunk(x, y, pcX, pcY);
+        wetContactChunks.set(pcX, pcY);
+    }
     chunk->setSettled(localX, localY, settled);
 }
 
@@ -734,7 +972,7 @@ void World::updateSandParticle(int x, int y) {
     bool rightOpen = (x < WORLD_WIDTH - 1 && (getParticle(x + 1, y + 1) == ParticleType::EMPTY || getParticle(x + 1, y + 1) == ParticleType::WATER));
 
     if (leftOpen && rightOpen) {
-        int newX = (std::rand() % 2) ? x - 1 : x + 1;
+        int newX = Random::local().coin() ? x - 1 : x + 1;
         if (getParticle(newX, y + 1) == ParticleType::EMPTY) {
             moveParticle(x, y, newX, y + 1);
         } else {
@@ -770,7 +1008,7 @@ void World::updateWaterParticle(int x, int y) {
     bool rightDiag = (x < WORLD_WIDTH - 1 && y + 1 < WORLD_HEIGHT && getParticle(x + 1, y + 1) == ParticleType::EMPTY);
 
     if (leftDiag && rightDiag) {
-        int newX = (std::rand() % 2) ? x - 1 : x + 1;
+        int newX = Random::local().coin() ? x - 1 : x + 1;
         moveParticle(x, y, newX, y + 1);
         return;
     }
@@ -788,7 +1026,7 @@ void World::updateWaterParticle(int x, int y) {
     if (flowSpeed <= 0) flowSpeed = 1; // Ensure at least 1 step
 
     // Randomly choose left or right preference
-    bool preferLeft = (std::rand() % 2 == 0);
+    bool preferLeft = Random::local().coin();
 
     for (int speed = flowSpeed; speed >= 1; --speed) { // Check furthest distances first
         // Try left
@@ -860,7 +1098,7 @@ void World::updateLavaParticle(int x, int y) {
     bool rightDiag = (x < WORLD_WIDTH - 1 && y + 1 < WORLD_HEIGHT && !isOccupied(x + 1, y + 1));
 
     if (leftDiag && rightDiag) {
-        int newX = (std::rand() % 2) ? x - 1 : x + 1;
+        int newX = Random::local().coin() ? x - 1 : x + 1;
         moveParticle(x, y, newX, y + 1);
         return;
     } else if (leftDiag) {
@@ -875,14 +1113,14 @@ void World::updateLavaParticle(int x, int y) {
     bool leftOpen = (x - 1 >= 0) && !isOccupied(x - 1, y);
     bool rightOpen = (x + 1 < WORLD_WIDTH) && !isOccupied(x + 1, y);
 
-    if (leftOpen && rightOpen && (std::rand() % 3 == 0)) {
-        int newX = (std::rand() % 2) ? x - 1 : x + 1;
+    if (leftOpen && rightOpen && (Random::local().below(3) == 0)) {
+        int newX = Random::local().coin() ? x - 1 : x + 1;
         moveParticle(x, y, newX, y);
         return;
-    } else if (leftOpen && (std::rand() % 3 == 0)) {
+    } else if (leftOpen && (Random::local().below(3) == 0)) {
         moveParticle(x, y, x - 1, y);
         return;
-    } else if (rightOpen && (std::rand() % 3 == 0)) {
+    } else if (rightOpen && (Random::local().below(3) == 0)) {
         moveParticle(x, y, x + 1, y);
         return;
     }
@@ -903,7 +1141,7 @@ void World::updateSteamParticle(int x, int y) {
     bool rightUp = (x < WORLD_WIDTH - 1 && y > 0 && !isOccupied(x + 1, y - 1));
 
     if (leftUp && rightUp) {
-        int newX = (std::rand() % 2) ? x - 1 : x + 1;
+        int newX = Random::local().coin() ? x - 1 : x + 1;
         moveParticle(x, y, newX, y - 1);
     } else if (leftUp) {
         moveParticle(x, y, x - 1, y - 1);
@@ -914,14 +1152,14 @@ void World::updateSteamParticle(int x, int y) {
 
 void World::updateFireParticle(int x, int y) {
     // Fire rises and flickers
-    if (y > 0 && !isOccupied(x, y - 1) && (std::rand() % 2 == 0)) {
+    if (y > 0 && !isOccupied(x, y - 1) && Random::local().coin()) {
         moveParticle(x, y, x, y - 1);
         return;
     }
 
     // Random sideways movement
-    if (std::rand() % 3 == 0) {
-        int dx = (std::rand() % 3) - 1;  // -1, 0, or 1
+    if (Random::local().below(3) == 0) {
+        int dx = Random::local().range(-1, 1);  // -1, 0, or 1
         int newX = x + dx;
         if (newX >= 0 && newX < WORLD_WIDTH && !isOccupied(newX, y)) {
             moveParticle(x, y, newX, y);
@@ -939,59 +1177,6 @@ void World::updateMossParticle(int x, int y) {
     markSettled(x, y, true);
 }
 
-
-
-
-void World::updateWetnessForParticle(int x, int y) {
-    ParticleType type = getParticle(x, y);
-    if (type == ParticleType::EMPTY || type == ParticleType::WATER) {
-        return;
-    }
-
-    // Absorption
-    float currentWetness = getWetness(x, y);
-    float maxSaturation = getMaxSaturation(type);
-    if (currentWetness < maxSaturation) {
-        for (int dy = -1; dy <= 1; ++dy) {
-            for (int dx = -1; dx <= 1; ++dx) {
-                if (dx == 0 && dy == 0) continue;
-                int nx = x + dx;
-                int ny = y + dy;
-                if (inWorldBounds(nx, ny) && getParticle(nx, ny) == ParticleType::WATER) {
-                    float absorbAmount = config.wetnessAbsorptionRate * (maxSaturation - currentWetness);
-                    setWetness(x, y, currentWetness + absorbAmount);
-                    // For simplicity, we don't remove the water particle.
-                    // In a more complex simulation, we might.
-                }
-            }
-        }
-    }
-
-    // Spreading
-    currentWetness = getWetness(x, y);
-    if (currentWetness > config.wetnessMinimumThreshold) {
-        for (int dy = -1; dy <= 1; ++dy) {
-            for (int dx = -1; dx <= 1; ++dx) {
-                if (dx == 0 && dy == 0) continue;
-                int nx = x + dx;
-                int ny = y + dy;
-                if (inWorldBounds(nx, ny)) {
-                    ParticleType neighborType = getParticle(nx, ny);
-                    if (neighborType != ParticleType::EMPTY && neighborType != ParticleType::WATER) {
-                        float neighborWetness = getWetness(nx, ny);
-                        float maxNeighborSaturation = getMaxSaturation(neighborType);
-                        if (neighborWetness < maxNeighborSaturation && currentWetness > neighborWetness) {
-                            float transferAmount = (currentWetness - neighborWetness) * config.wetnessSpreadRate;
-                            setWetness(x, y, currentWetness - transferAmount);
-                            setWetness(nx, ny, neighborWetness + transferAmount);
-                        }
-                    }
-                }
-            }
-        }
-    }
-}
-
 void World::updateParticle(int worldX, int worldY) {
     ParticleType type = getParticle(worldX, worldY);
 
@@ -1023,131 +1208,887 @@ void World::updateParticle(int worldX, int worldY) {
 }
 
 
+int World::updateSimTile(const SimTile& tile, int startPCX, int startPCY, int endPCX, int endPCY, int& chunksProcessed) {
+    // Seeded by tile and tick, so the outcome does not depend on which thread runs the tile
+    Random::local().reseed(Random::hash(worldSeed, tile.tileX, tile.tileY, tickCount));
 
-void World::update(float deltaTime) {
-    static int callCount = 0;
-    callCount++;
-    auto t0 = std::chrono::high_resolution_clock::now();
-
-    loadChunksAroundCamera();
-    unloadDistantChunks();
-
-    auto t1 = std::chrono::high_resolution_clock::now();
+    int tilePCX0 = std::max(startPCX, tile.tileX * SIM_TILE_P_CHUNKS);
+    int tilePCY0 = std::max(startPCY, tile.tileY * SIM_TILE_P_CHUNKS);
+    int tilePCX1 = std::min(endPCX, tile.tileX * SIM_TILE_P_CHUNKS + SIM_TILE_P_CHUNKS - 1);
+    int tilePCY1 = std::min(endPCY, tile.tileY * SIM_TILE_P_CHUNKS + SIM_TILE_P_CHUNKS - 1);
 
-    // Determine visible particle chunk range to simulate
-    int visWorldX_start, visWorldY_start, visWorldX_end, visWorldY_end;
-    getVisibleRegion(visWorldX_start, visWorldY_start, visWorldX_end, visWorldY_end);
+    int particlesUpdated = 0;
 
-    int startPCX, startPCY, endPCX, endPCY;
-    worldToParticleChunk(visWorldX_start, visWorldY_start, startPCX, startPCY);
-    worldToParticleChunk(visWorldX_end - 1, visWorldY_end - 1, endPCX, endPCY);
+    // A tile is far smaller than a chunk, so its cells and everything its rules reach
+    // lie within the 3x3 chunks around the chunk holding the tile's first cell
+    ChunkNeighborhood neighborhood;
+    getChunkNeighborhood(tilePCX0 * PARTICLE_CHUNK_WIDTH / WorldChunk::CHUNK_SIZE,
+                         tilePCY0 * PARTICLE_CHUNK_HEIGHT / WorldChunk::CHUNK_SIZE, neighborhood);
 
-    // Simulate a border of 1 particle chunk around the visible area
-    startPCX = std::max(0, startPCX - 1);
-    startPCY = std::max(0, startPCY - 1);
-    endPCX = std::min(P_CHUNKS_X - 1, endPCX + 1);
-    endPCY = std::min(P_CHUNKS_Y - 1, endPCY + 1);
+    // Bottom-up, alternating direction per row of particle chunks (same order as the serial sweep)
+    for (int pcY = tilePCY1; pcY >= tilePCY0; --pcY) {
+        bool leftToRight = (pcY % 2 == 0);
+        for (int i = 0; i <= tilePCX1 - tilePCX0; ++i) {
+            int pcX = leftToRight ? tilePCX0 + i : tilePCX1 - i;
 
-    // Clear activity only for visible region + border (not entire array)
-    for (int pcY = startPCY; pcY <= endPCY; ++pcY) {
-        for (int pcX = startPCX; pcX <= endPCX; ++pcX) {
-            particleChunkActivity[pcY * P_CHUNKS_X + pcX] = false;
+            if (!awakeParticleChunks.test(pcX, pcY)) {
+                continue;
+            }
+            chunksProcessed++;
+            particlesUpdated += updateParticleChunk(pcX, pcY, neighborhood);
         }
     }
 
-    auto t2 = std::chrono::high_resolution_clock::now();
+    return particlesUpdated;
+}
 
-    static int updateCallCount = 0;
-    updateCallCount++;
-    int particlesUpdated = 0;
-    int chunksProcessed = 0;
+int World::updateParticleChunk(int pcX, int pcY, const ChunkNeighborhood& neighborhood) {
+    int startWorldX = pcX * PARTICLE_CHUNK_WIDTH;
+    int startWorldY = pcY * PARTICLE_CHUNK_HEIGHT;
+    int endWorldX = startWorldX + PARTICLE_CHUNK_WIDTH;
+    int endWorldY = startWorldY + PARTICLE_CHUNK_HEIGHT;
 
-    for (int pcY = endPCY; pcY >= startPCY; --pcY) {
-        bool leftToRight = (pcY % 2 == 0);
-        for (int i = 0; i < (endPCX - startPCX + 1); ++i) {
-            int pcX = startPCX + (leftToRight ? i : (endPCX - startPCX - i));
+    int particlesUpdated = 0;
 
-            int pcIndex = pcY * P_CHUNKS_X + pcX;
-            if (!particleChunks[pcIndex].isAwake) {
-                continue;
-            }
-            chunksProcessed++;
+    for (int y = endWorldY - 1; y >= startWorldY; --y) {
+        if (y < 0 || y >= WORLD_HEIGHT) continue;
+        for (int x = startWorldX; x < endWorldX; ++x) {
+            if (x < 0 || x >= WORLD_WIDTH) continue;
 
-            int startWorldX = pcX * PARTICLE_CHUNK_WIDTH;
-            int startWorldY = pcY * PARTICLE_CHUNK_HEIGHT;
-            int endWorldX = startWorldX + PARTICLE_CHUNK_WIDTH;
-            int endWorldY = startWorldY + PARTICLE_CHUNK_HEIGHT;
+            WorldChunk* chunk = neighborhood.at(x, y);
+            if (!chunk) continue;
 
-            for (int y = endWorldY - 1; y >= startWorldY; --y) {
-                 if (y < 0 || y >= WORLD_HEIGHT) continue;
-                for (int x = startWorldX; x < endWorldX; ++x) {
-                    if (x < 0 || x >= WORLD_WIDTH) continue;
+            int localX, localY;
+            worldToLocal(x, y, localX, localY);
+            ParticleType type = chunk->getParticle(localX, localY);
+            if (type == ParticleType::EMPTY) continue;
 
-                    ParticleType type = getParticle(x, y);
-                    if (type != ParticleType::EMPTY) {
-                        updateParticle(x, y);
-                        particlesUpdated++;
-                    }
+            // Already updated this frame (moved here from a cell scanned earlier)
+            if (chunk->getUpdateParity(localX, localY) == frameParity) continue;
+
+            // Sand and water falling straight down: a run of them across the row moves a plane
+            // at a time. The rules only look at the cell below for a straight fall, so this is
+            // the same as updating the run cell by cell.
+            if (type == ParticleType::SAND || type == ParticleType::WATER) {
+                int run = chunk->countFallingRun(localX, localY, std::min(endWorldX, WORLD_WIDTH) - x, frameParity);
+                if (run > 0) {
+                    dropFallingRun(chunk, x, y, run);
+                    particlesUpdated += run;
+                    x += run - 1;
+                    continue;
                 }
             }
+
+            chunk->setUpdateParity(localX, localY, frameParity);
+            updateParticle(x, y);
+            particlesUpdated++;
         }
     }
 
-    auto t3 = std::chrono::high_resolution_clock::now();
+    return particlesUpdated;
+}
 
-    // Update sleep states - ONLY for visible region + border, not all chunks!
-    int sleepStartPCX = std::max(0, startPCX - 2);
-    int sleepStartPCY = std::max(0, startPCY - 2);
-    int sleepEndPCX = std::min(P_CHUNKS_X - 1, endPCX + 2);
-    int sleepEndPCY = std::min(P_CHUNKS_Y - 1, endPCY + 2);
-
-    for (int pcY = sleepStartPCY; pcY <= sleepEndPCY; ++pcY) {
-        for (int pcX = sleepStartPCX; pcX <= sleepEndPCX; ++pcX) {
-            int i = pcY * P_CHUNKS_X + pcX;
-            if (particleChunkActivity[i]) {
-                particleChunks[i].isAwake = true;
-                particleChunks[i].stableFrames = 0;
-                // Wake up neighbors
-                for (int dy = -1; dy <= 1; ++dy) {
-                    for (int dx = -1; dx <= 1; ++dx) {
-                        if (dx == 0 && dy == 0) continue;
-                        int nPcX = pcX + dx;
-                        int nPcY = pcY + dy;
-                        if (nPcX >= 0 && nPcX < P_CHUNKS_X && nPcY >= 0 && nPcY < P_CHUNKS_Y) {
-                            int neighborIdx = nPcY * P_CHUNKS_X + nPcX;
-                            particleChunks[neighborIdx].isAwake = true;
-                            particleChunks[neighborIdx].stableFrames = 0;
-                        }
-                    }
-                }
-            } else {
-                if (particleChunks[i].isAwake) {
-                    particleChunks[i].stableFrames++;
-                    if (particleChunks[i].stableFrames > P_CHUNK_FRAMES_UNTIL_SLEEP) {
-                        particleChunks[i].isAwake = false;
-                    }
-                }
-            }
+void World::wakeParticleChunks(int startPCX, int startPCY, int endPCX, int endPCY) {
+    startPCX = std::max(startPCX, 0);
+    startPCY = std::max(startPCY, 0);
+    endPCX = std::min(endPCX, P_CHUNKS_X - 1);
+    endPCY = std::min(endPCY, P_CHUNKS_Y - 1);
+    if (startPCX > endPCX || startPCY > endPCY) return;
+
+    for (int pcY = startPCY; pcY <= endPCY; ++pcY) {
+        for (int word = startPCX / BitGrid::WORD_BITS; word <= endPCX / BitGrid::WORD_BITS; ++word) {
+            uint64_t woken = BitGrid::columnMask(word, startPCX, endPCX) & ~awakeParticleChunks.word(word, pcY);
+            BitGrid::forEachBit(woken, word, [&](int pcX) { stampWokenParticleChunk(pcX, pcY); });
+        }
+    }
+    awakeParticleChunks.fill(startPCX, startPCY, endPCX, endPCY, true);
+    for (int pcY = startPCY; pcY <= endPCY; ++pcY) {
+        std::fill_n(&particleChunkStableFrames[pcY * P_CHUNKS_X + startPCX], endPCX - startPCX + 1, 0);
+    }
+}
+
+void World::stampWokenParticleChunk(int pcX, int pcY) {
+    // Asleep, the chunk's cells kept the parity of whichever frame last touched them, which
+    // matches the next frame's parity about half the time. Stamp them with the current one so
+    // the next sweep updates all of them. Wake-ups happen between sweeps, never during one,
+    // so no cell of a sleeping chunk carries a stamp from a sweep still in progress.
+    int x0 = pcX * PARTICLE_CHUNK_WIDTH, y0 = pcY * PARTICLE_CHUNK_HEIGHT;
+    int x1 = std::min(x0 + PARTICLE_CHUNK_WIDTH, WORLD_WIDTH), y1 = std::min(y0 + PARTICLE_CHUNK_HEIGHT, WORLD_HEIGHT);
+
+    // A particle chunk can straddle up to four world chunks
+    for (int y = y0; y < y1; y = (y / WorldChunk::CHUNK_SIZE + 1) * WorldChunk::CHUNK_SIZE) {
+        for (int x = x0; x < x1; x = (x / WorldChunk::CHUNK_SIZE + 1) * WorldChunk::CHUNK_SIZE) {
+            WorldChunk* chunk = findChunkAtWorldPos(x, y);
+            if (!chunk) continue;
+            int localX, localY;
+            worldToLocal(x, y, localX, localY);
+            chunk->fillUpdateParity(localX, localY, localX + x1 - x, localY + y1 - y, frameParity);
+        }
+    }
+}
+
+void World::wakeMovableParticleChunks(const WorldChunk& chunk) {
+    // Solid particles never move on their own, so chunks of terrain alone stay asleep
+    int movable = 0;
+    for (ParticleType type : {ParticleType::SAND, ParticleType::WATER, ParticleType::LAVA, ParticleType::STEAM, ParticleType::FIRE}) {
+        movable += chunk.getTypeCount(type);
+    }
+    if (movable == 0) return;
+
+    // Water placed next to absorbent particles: look for wetness contacts around it
+    bool soaks = chunk.getTypeCount(ParticleType::WATER) > 0 &&
+                 chunk.getTypeCount(ParticleType::SAND) + chunk.getTypeCount(ParticleType::WOOD) + chunk.getTypeCount(ParticleType::MOSS) > 0;
+
+    int originX = chunk.getChunkX() * WorldChunk::CHUNK_SIZE;
+    int originY = chunk.getChunkY() * WorldChunk::CHUNK_SIZE;
+    const ParticleType* grid = chunk.getParticleGrid().data();
+
+    for (int pcY = originY / PARTICLE_CHUNK_HEIGHT; pcY <= (originY + WorldChunk::CHUNK_SIZE - 1) / PARTICLE_CHUNK_HEIGHT; ++pcY) {
+        int y0 = std::max(pcY * PARTICLE_CHUNK_HEIGHT - originY, 0);
+        int y1 = std::min((pcY + 1) * PARTICLE_CHUNK_HEIGHT - originY, WorldChunk::CHUNK_SIZE);
+        for (int pcX = originX / PARTICLE_CHUNK_WIDTH; pcX <= (originX + WorldChunk::CHUNK_SIZE - 1) / PARTICLE_CHUNK_WIDTH; ++pcX) {
+            int x0 = std::max(pcX * PARTICLE_CHUNK_WIDTH - originX, 0);
+            int x1 = std::min((pcX + 1) * PARTICLE_CHUNK_WIDTH - originX, WorldChunk::CHUNK_SIZE);
+
+            bool hasMovable = false;
+            bool hasWater = false;
+            for (int y = y0; y < y1 && !(hasMovable && (hasWater || !soaks)); ++y) {
+                for (int x = x0; x < x1; ++x) {
+                    ParticleType type = grid[y * WorldChunk::CHUNK_SIZE + x];
+                    if (type != ParticleType::EMPTY && !isSolidParticle(type)) hasMovable = true;
+                    if (type == ParticleType::WATER) hasWater = true;
+                }
+            }
+            if (hasMovable) wakeParticleChunks(pcX, pcY, pcX, pcY);
+            if (hasWater && soaks) wetContactChunks.set(pcX, pcY);
+        }
+    }
+}
+
+void World::updateSleepStates(int startPCX, int startPCY, int endPCX, int endPCY) {
+    PROFILE_SCOPE("sleep update");
+    constexpr int BITS = BitGrid::WORD_BITS;
+
+    // Words covering the range plus the column either side, which wake-ups spill into
+    int firstWord = std::max(startPCX - 1, 0) / BITS;
+    int lastWord = std::min(endPCX + 1, P_CHUNKS_X - 1) / BITS;
+    int wordCount = lastWord - firstWord + 1;
+    int rows = endPCY - startPCY + 1;
+
+    // Take this update's movement inside the range (a row of words per particle chunk row,
+    // with an empty row above and below). Movement outside, from rules reaching past the
+    // range, is left for the pass that covers those chunks.
+    sleepActivityRows.assign((rows + 2) * wordCount, 0);
+    for (int pcY = startPCY; pcY <= endPCY; ++pcY) {
+        for (int word = firstWord; word <= lastWord; ++word) {
+            sleepActivityRows[(pcY - startPCY + 1) * wordCount + word - firstWord] =
+                particleChunkActivity.word(word, pcY) & BitGrid::columnMask(word, startPCX, endPCX);
+        }
+    }
+    particleChunkActivity.fill(startPCX, startPCY, endPCX, endPCY, false);
+
+    // Movement in a row of words or the rows above and below it
+    auto movedAround = [&](int row, int word) -> uint64_t {
+        if (word < firstWord || word > lastWord) return 0;
+        uint64_t bits = 0;
+        for (int r = std::max(row - 1, 0); r <= std::min(row + 1, rows + 1); ++r) {
+            bits |= sleepActivityRows[r * wordCount + word - firstWord];
+        }
+        return bits;
+    };
+
+    // A chunk that moved wakes itself and its 8 neighbours; awake chunks in the range that
+    // were not woken count towards sleep
+    for (int pcY = std::max(startPCY - 1, 0); pcY <= std::min(endPCY + 1, P_CHUNKS_Y - 1); ++pcY) {
+        int row = pcY - startPCY + 1;
+        bool inRange = pcY >= startPCY && pcY <= endPCY;
+
+        for (int word = firstWord; word <= lastWord; ++word) {
+            uint64_t moved = movedAround(row, word);
+            uint64_t wake = moved | (moved << 1) | (moved >> 1) |
+                            (movedAround(row, word - 1) >> (BITS - 1)) |
+                            (movedAround(row, word + 1) << (BITS - 1));
+            uint64_t awake = awakeParticleChunks.word(word, pcY) | wake;
+            unsigned char* stableFrames = &particleChunkStableFrames[pcY * P_CHUNKS_X];
+
+            BitGrid::forEachBit(wake & ~awakeParticleChunks.word(word, pcY), word,
+                                [&](int pcX) { stampWokenParticleChunk(pcX, pcY); });
+            BitGrid::forEachBit(wake, word, [&](int pcX) { stableFrames[pcX] = 0; });
+            if (inRange) {
+                uint64_t resting = awake & ~wake & BitGrid::columnMask(word, startPCX, endPCX);
+                BitGrid::forEachBit(resting, word, [&](int pcX) {
+                    if (++stableFrames[pcX] > P_CHUNK_FRAMES_UNTIL_SLEEP) awake &= ~(1ull << (pcX % BITS));
+                });
+            }
+            awakeParticleChunks.setWord(word, pcY, awake);
+        }
+    }
+}
+
+int World::runSimTilePhases(int startPCX, int startPCY, int endPCX, int endPCY, int& chunksProcessed) {
+    int particlesUpdated = 0;
+
+    // Tiles within one phase never touch each other's cells, so each phase runs in parallel.
+    // Dynamic scheduling lets idle threads pick up the next tile as soon as they finish.
+    for (const auto& phase : simTilePhases) {
+        PROFILE_SCOPE("particle sim");
+        int tileCount = (int)phase.size();
+
+        #pragma omp parallel for schedule(dynamic, 1) reduction(+:particlesUpdated, chunksProcessed) if(config.parallelSimulation && tileCount > 1)
+        for (int t = 0; t < tileCount; ++t) {
+            int tileChunks = 0;
+            particlesUpdated += updateSimTile(phase[t], startPCX, startPCY, endPCX, endPCY, tileChunks);
+            chunksProcessed += tileChunks;
+        }
+    }
+
+    return particlesUpdated;
+}
+
+void World::getLoadedParticleChunkRange(int& startPCX, int& startPCY, int& endPCX, int& endPCY) const {
+    int centerChunkX = (int)(camera.x + camera.viewportWidth / 2) / WorldChunk::CHUNK_SIZE;
+    int centerChunkY = (int)(camera.y + camera.viewportHeight / 2) / WorldChunk::CHUNK_SIZE;
+    startPCX = std::max(0, centerChunkX - LOAD_RADIUS) * WorldChunk::CHUNK_SIZE / PARTICLE_CHUNK_WIDTH;
+    startPCY = std::max(0, centerChunkY - LOAD_RADIUS) * WorldChunk::CHUNK_SIZE / PARTICLE_CHUNK_HEIGHT;
+    endPCX = (std::min(WORLD_CHUNKS_X, centerChunkX + LOAD_RADIUS + 1) * WorldChunk::CHUNK_SIZE - 1) / PARTICLE_CHUNK_WIDTH;
+    endPCY = (std::min(WORLD_CHUNKS_Y, centerChunkY + LOAD_RADIUS + 1) * WorldChunk::CHUNK_SIZE - 1) / PARTICLE_CHUNK_HEIGHT;
+}
+
+void World::updateOffscreenTiles(int viewTileX0, int viewTileY0, int viewTileX1, int viewTileY1,
+                                 int& particlesUpdated, int& chunksProcessed) {
+    lastUpdateStats.offscreenTiles = 0;
+    lastUpdateStats.offscreenDeferred = 0;
+    int interval = config.offscreenSimulationInterval;
+    if (interval <= 0) return;
+    PROFILE_SCOPE("offscreen sim");
+
+    // Tiles of the chunks kept loaded around the camera
+    int startPCX, startPCY, endPCX, endPCY;
+    getLoadedParticleChunkRange(startPCX, startPCY, endPCX, endPCY);
+
+    // Due: awake chunks (or movement that will wake them) and no update for at least
+    // `interval` ticks. The gap must also be odd: cells keep the parity of the tick that last
+    // updated them, and after an even gap they would look as if already updated.
+    uint32_t tick = (uint32_t)tickCount;
+    offscreenDue.clear();
+    for (int tileY = startPCY / SIM_TILE_P_CHUNKS; tileY <= endPCY / SIM_TILE_P_CHUNKS; ++tileY) {
+        int tilePCY0 = std::max(startPCY, tileY * SIM_TILE_P_CHUNKS);
+        int tilePCY1 = std::min(endPCY, tileY * SIM_TILE_P_CHUNKS + SIM_TILE_P_CHUNKS - 1);
+        bool viewRow = tileY >= viewTileY0 && tileY <= viewTileY1;
+        int lastTileX = -1;
+
+        for (int word = startPCX / BitGrid::WORD_BITS; word <= endPCX / BitGrid::WORD_BITS; ++word) {
+            uint64_t pending = 0;
+            for (int pcY = tilePCY0; pcY <= tilePCY1; ++pcY) {
+                pending |= awakeParticleChunks.word(word, pcY) | particleChunkActivity.word(word, pcY);
+            }
+            pending &= BitGrid::columnMask(word, startPCX, endPCX);
+
+            BitGrid::forEachBit(pending, word, [&](int pcX) {
+                int tileX = pcX / SIM_TILE_P_CHUNKS;
+                if (tileX == lastTileX) return;
+                lastTileX = tileX;
+                if (viewRow && tileX >= viewTileX0 && tileX <= viewTileX1) return;
+
+                uint32_t lastTick = simTileLastTick[tileY * SIM_TILES_X + tileX];
+                uint32_t gap = tick - lastTick;
+                if (lastTick != 0 && (gap < (uint32_t)interval || gap % 2 == 0)) return;
+                offscreenDue.push_back({tileX, tileY});
+            });
+        }
+    }
+
+    // Longest-waiting tiles first, so every due tile gets its turn when the budget is short
+    std::sort(offscreenDue.begin(), offscreenDue.end(), [&](const SimTile& a, const SimTile& b) {
+        uint32_t lastA = simTileLastTick[a.tileY * SIM_TILES_X + a.tileX];
+        uint32_t lastB = simTileLastTick[b.tileY * SIM_TILES_X + b.tileX];
+        if (lastA != lastB) return lastA < lastB;
+        return a.tileY != b.tileY ? a.tileY > b.tileY : a.tileX < b.tileX;
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    float budgetMs = config.offscreenSimulationBudgetMs;
+    size_t next = 0;
+    while (next < offscreenDue.size()) {
+        if (budgetMs > 0.0f && std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() >= budgetMs) {
+            break;
+        }
+
+        size_t batchEnd = std::min(offscreenDue.size(), next + OFFSCREEN_BATCH_TILES);
+        for (auto& phase : simTilePhases) {
+            phase.clear();
+        }
+        for (size_t i = next; i < batchEnd; ++i) {
+            const SimTile& tile = offscreenDue[i];
+            simTilePhases[(tile.tileX & 1) | ((tile.tileY & 1) << 1)].push_back(tile);
+        }
+        particlesUpdated += runSimTilePhases(startPCX, startPCY, endPCX, endPCY, chunksProcessed);
+
+        for (size_t i = next; i < batchEnd; ++i) {
+            const SimTile& tile = offscreenDue[i];
+            simTileLastTick[tile.tileY * SIM_TILES_X + tile.tileX] = tick;
+            updateSleepStates(std::max(startPCX, tile.tileX * SIM_TILE_P_CHUNKS),
+                              std::max(startPCY, tile.tileY * SIM_TILE_P_CHUNKS),
+                              std::min(endPCX, tile.tileX * SIM_TILE_P_CHUNKS + SIM_TILE_P_CHUNKS - 1),
+                              std::min(endPCY, tile.tileY * SIM_TILE_P_CHUNKS + SIM_TILE_P_CHUNKS - 1));
         }
+        next = batchEnd;
     }
 
+    lastUpdateStats.offscreenTiles = (int)next;
+    lastUpdateStats.offscreenDeferred = (int)(offscreenDue.size() - next);
+}
+
+void World::initThermalProperties() {
+    const std::pair<ParticleType, const ParticleTypeConfig*> types[] = {
+        {ParticleType::SAND, &config.sand},         {ParticleType::WATER, &config.water},
+        {ParticleType::ROCK, &config.rock},         {ParticleType::LAVA, &config.lava},
+        {ParticleType::STEAM, &config.steam},       {ParticleType::OBSIDIAN, &config.obsidian},
+        {ParticleType::FIRE, &config.fire},         {ParticleType::ICE, &config.ice},
+        {ParticleType::GLASS, &config.glass},       {ParticleType::WOOD, &config.wood},
+        {ParticleType::MOSS, &config.moss},
+    };
+
+    thermal[(int)ParticleType::EMPTY] = {0.0f, 0.0f, AMBIENT_TEMPERATURE, 0.0f, 0.0f};
+    for (const auto& [type, typeConfig] : types) {
+        ThermalProperties& props = thermal[(int)type];
+        props.conductivity = typeConfig->thermalConductivity;
+        props.transferScale = typeConfig->heatCapacity > 0.0f ? config.energyConversionFactor * 0.5f / typeConfig->heatCapacity : 0.0f;
+        props.startTemperature = typeConfig->baseTemperature;
+        props.meltingPoint = typeConfig->meltingPoint;
+        props.boilingPoint = typeConfig->boilingPoint;
+    }
+
+    // Obsidian and glass are hot only when they have just formed, which a phase change
+    // handles by keeping the cell's temperature. Placed or generated, they start cold.
+    thermal[(int)ParticleType::OBSIDIAN].startTemperature = AMBIENT_TEMPERATURE;
+    thermal[(int)ParticleType::GLASS].startTemperature = AMBIENT_TEMPERATURE;
+}
+
+void World::initChunkTemperatures(WorldChunk& chunk) {
+    // Chunks restored from the region cache bring their temperatures with them
+    if (!chunk.getTemperatureValues()) {
+        bool anyHeat = false;
+        for (int type = 1; type < PARTICLE_TYPE_COUNT; ++type) {
+            if (chunk.getTypeCount((ParticleType)type) > 0 && !isAmbient(thermal[type].startTemperature)) anyHeat = true;
+        }
+        if (!anyHeat) return;
+
+        float* temperatures = chunk.allocateTemperatureValues();
+        const std::vector<ParticleType>& types = chunk.getParticleGrid();
+        for (size_t i = 0; i < types.size(); ++i) {
+            temperatures[i] = thermal[(int)types[i]].startTemperature;
+        }
+    }
+
+    constexpr int TILES_PER_CHUNK = WorldChunk::CHUNK_SIZE / HEAT_TILE_SIZE;
+    int tileX = chunk.getWorldX() / HEAT_TILE_SIZE;
+    int tileY = chunk.getWorldY() / HEAT_TILE_SIZE;
+    warmHeatTiles.fill(tileX, tileY, tileX + TILES_PER_CHUNK - 1, tileY + TILES_PER_CHUNK - 1, true);
+}
+
+ParticleType World::phaseChange(ParticleType type, float temperature) const {
+    const ThermalProperties& props = thermal[(int)type];
+    switch (type) {
+        case ParticleType::ICE:
+            return temperature >= props.meltingPoint ? ParticleType::WATER : type;
+        case ParticleType::WATER:
+            if (temperature < props.meltingPoint) return ParticleType::ICE;
+            if (temperature >= props.boilingPoint) return ParticleType::STEAM;
+            return type;
+        case ParticleType::STEAM:
+            // Condenses where water stops boiling (steam's own boiling point is a placeholder)
+            return temperature < thermal[(int)ParticleType::WATER].boilingPoint ? ParticleType::WATER : type;
+        case ParticleType::SAND:
+            return temperature >= props.meltingPoint ? ParticleType::GLASS : type;
+        case ParticleType::LAVA:
+            return temperature < props.meltingPoint ? ParticleType::OBSIDIAN : type;
+        case ParticleType::WOOD:
+            return temperature >= props.boilingPoint ? ParticleType::FIRE : type;
+        default:
+            return type;  // Obsidian and glass never melt back
+    }
+}
+
+int World::updateHeat(int startX, int startY, int endX, int endY, int& phaseChanges) {
+    PROFILE_SCOPE("heat");
+    constexpr int BITS = BitGrid::WORD_BITS;
+    constexpr int TILE_CELLS = HEAT_TILE_SIZE * HEAT_TILE_SIZE;
+
+    int startTileX = startX / HEAT_TILE_SIZE;
+    int startTileY = startY / HEAT_TILE_SIZE;
+    int endTileX = endX / HEAT_TILE_SIZE;
+    int endTileY = endY / HEAT_TILE_SIZE;
+
+    // Warm tiles in a row of words or the rows above and below it
+    auto warmAround = [&](int tileY, int word) -> uint64_t {
+        if (word < 0 || word >= warmHeatTiles.getWordsPerRow()) return 0;
+        uint64_t bits = 0;
+        for (int y = std::max(tileY - 1, 0); y <= std::min(tileY + 1, HEAT_TILES_Y - 1); ++y) {
+            bits |= warmHeatTiles.word(word, y);
+        }
+        return bits;
+    };
+
+    // Warm tiles and their 8 neighbours: heat flows out of a warm tile into cold ones
+    heatTileList.clear();
+    for (int tileY = startTileY; tileY <= endTileY; ++tileY) {
+        for (int word = startTileX / BITS; word <= endTileX / BITS; ++word) {
+            uint64_t warm = warmAround(tileY, word);
+            uint64_t swept = warm | (warm << 1) | (warm >> 1) |
+                             (warmAround(tileY, word - 1) >> (BITS - 1)) |
+                             (warmAround(tileY, word + 1) << (BITS - 1));
+            swept &= BitGrid::columnMask(word, startTileX, endTileX);
+            BitGrid::forEachBit(swept, word, [&](int tileX) { heatTileList.push_back({tileX, tileY}); });
+        }
+    }
+
+    int tileCount = (int)heatTileList.size();
+    heatOutput.resize((size_t)tileCount * TILE_CELLS);
+
+    // Every tile reads the temperatures from before the pass and writes its own buffer, so
+    // tiles can run in any order; the results and phase changes are applied afterwards
+    #pragma omp parallel for schedule(dynamic, 4) if(config.parallelSimulation && tileCount > 1)
+    for (int i = 0; i < tileCount; ++i) {
+        diffuseHeatTile(heatTileList[i], &heatOutput[(size_t)i * TILE_CELLS]);
+    }
+
+    heatTileChanges.assign(tileCount, 0);
+    #pragma omp parallel for schedule(dynamic, 4) if(config.parallelSimulation && tileCount > 1)
+    for (int i = 0; i < tileCount; ++i) {
+        heatTileChanges[i] = applyHeatTile(heatTileList[i], &heatOutput[(size_t)i * TILE_CELLS]);
+    }
+
+    static_assert(HEAT_TILE_SIZE == RENDER_TILE_SIZE, "heat tiles flag their render tile by its corner");
+    // Tiles are not phased, so a tile's glow flag (the render tile above) is another tile's
+    // own flag: flag changed tiles here, once each, rather than per cell from the loop. A heat
+    // tile is exactly a render tile, and its top-left cell flags both.
+    int changes = 0;
+    for (int i = 0; i < tileCount; ++i) {
+        if (heatTileChanges[i] == 0) continue;
+        markRenderDirty(heatTileList[i].tileX * HEAT_TILE_SIZE, heatTileList[i].tileY * HEAT_TILE_SIZE);
+        changes += heatTileChanges[i];
+    }
+
+    PROFILE_COUNT("heat tiles", tileCount);
+    phaseChanges = changes;
+    return tileCount;
+}
+
+void World::diffuseHeatTile(const HeatTile& tile, float* output) const {
+    constexpr int SIZE = HEAT_TILE_SIZE;
+    constexpr int PADDED = SIZE + 2;
+    int left = tile.tileX * SIZE;
+    int top = tile.tileY * SIZE;
+
+    // The tile and a ring of one cell around it: temperature, conductivity, whether the
+    // cell holds a particle, and how far a unit of heat flow moves its temperature
+    float temperature[PADDED * PADDED];
+    float conductivity[PADDED * PADDED];
+    float occupied[PADDED * PADDED];
+    float transferScale[PADDED * PADDED];
+
+    auto store = [&](int index, ParticleType type, float t) {
+        const ThermalProperties& props = thermal[(int)type];
+        temperature[index] = t;
+        conductivity[index] = props.conductivity;
+        occupied[index] = type != ParticleType::EMPTY ? 1.0f : 0.0f;
+        transferScale[index] = props.transferScale;
+    };
+    auto sample = [&](int index, int worldX, int worldY) {
+        const WorldChunk* chunk = findChunkAtWorldPos(worldX, worldY);
+        if (!chunk) {
+            store(index, ParticleType::EMPTY, AMBIENT_TEMPERATURE);
+            return;
+        }
+        int localX, localY;
+        worldToLocal(worldX, worldY, localX, localY);
+        store(index, chunk->getParticle(localX, localY), chunk->getTemperature(localX, localY));
+    };
+
+    for (int row = 0; row < PADDED; ++row) {
+        int worldY = top + row - 1;
+        sample(row * PADDED, left - 1, worldY);
+        sample(row * PADDED + PADDED - 1, left + SIZE, worldY);
+
+        // The tile's columns lie in one chunk (tiles divide chunks evenly)
+        const WorldChunk* chunk = findChunkAtWorldPos(left, worldY);
+        if (!chunk) {
+            for (int i = 1; i <= SIZE; ++i) store(row * PADDED + i, ParticleType::EMPTY, AMBIENT_TEMPERATURE);
+            continue;
+        }
+        int localX, localY;
+        worldToLocal(left, worldY, localX, localY);
+        int first = localY * WorldChunk::CHUNK_SIZE + localX;
+        const ParticleType* types = &chunk->getParticleGrid()[first];
+        const float* temperatures = chunk->getTemperatureValues();
+        for (int i = 0; i < SIZE; ++i) {
+            store(row * PADDED + 1 + i, types[i], temperatures ? temperatures[first + i] : AMBIENT_TEMPERATURE);
+        }
+    }
+
+    // Heat flows between neighbouring particles (8-connected) in proportion to their mean
+    // conductivity and temperature difference, as in the legacy SandSimulator model
+    for (int y = 1; y <= SIZE; ++y) {
+        const float* tUp = &temperature[(y - 1) * PADDED];
+        const float* tMid = &temperature[y * PADDED];
+        const float* tDown = &temperature[(y + 1) * PADDED];
+        const float* kUp = &conductivity[(y - 1) * PADDED];
+        const float* kMid = &conductivity[y * PADDED];
+        const float* kDown = &conductivity[(y + 1) * PADDED];
+        const float* mUp = &occupied[(y - 1) * PADDED];
+        const float* mMid = &occupied[y * PADDED];
+        const float* mDown = &occupied[(y + 1) * PADDED];
+        const float* scale = &transferScale[y * PADDED];
+        float* out = &output[(y - 1) * SIZE];
+
+        #pragma omp simd
+        for (int x = 1; x <= SIZE; ++x) {
+            float t = tMid[x];
+            float k = kMid[x];
+            float flow = mUp[x - 1] * (k + kUp[x - 1]) * (tUp[x - 1] - t)
+                       + mUp[x] * (k + kUp[x]) * (tUp[x] - t)
+                       + mUp[x + 1] * (k + kUp[x + 1]) * (tUp[x + 1] - t)
+                       + mMid[x - 1] * (k + kMid[x - 1]) * (tMid[x - 1] - t)
+                       + mMid[x + 1] * (k + kMid[x + 1]) * (tMid[x + 1] - t)
+                       + mDown[x - 1] * (k + kDown[x - 1]) * (tDown[x - 1] - t)
+                       + mDown[x] * (k + kDown[x]) * (tDown[x] - t)
+                       + mDown[x + 1] * (k + kDown[x + 1]) * (tDown[x + 1] - t);
+            out[x - 1] = t + flow * scale[x];  // Scale is 0 for empty cells
+        }
+    }
+}
+
+int World::applyHeatTile(const HeatTile& tile, const float* output) {
+    constexpr int SIZE = HEAT_TILE_SIZE;
+    int left = tile.tileX * SIZE;
+    int top = tile.tileY * SIZE;
+
+    WorldChunk* chunk = findChunkAtWorldPos(left, top);
+    if (!chunk) {
+        warmHeatTiles.clear(tile.tileX, tile.tileY);
+        return 0;
+    }
+
+    int localLeft, localTop;
+    worldToLocal(left, top, localLeft, localTop);
+    const std::vector<ParticleType>& types = chunk->getParticleGrid();
+
+    bool warm = false;
+    for (int y = 0; y < SIZE && !warm; ++y) {
+        int first = (localTop + y) * WorldChunk::CHUNK_SIZE + localLeft;
+        for (int x = 0; x < SIZE; ++x) {
+            if (types[first + x] != ParticleType::EMPTY && !isAmbient(output[y * SIZE + x])) {
+                warm = true;
+                break;
+            }
+        }
+    }
+
+    // Nothing away from ambient and no plane to update: no heat and no phase changes here
+    if (!warm && !chunk->getTemperatureValues()) {
+        warmHeatTiles.clear(tile.tileX, tile.tileY);
+        return 0;
+    }
+
+    // Seeded by tile and tick, like the simulation tiles, for the colours of new particles
+    Random::local().reseed(Random::hash(worldSeed, tile.tileX, tile.tileY, tickCount ^ HEAT_SALT));
+
+    float* temperatures = chunk->allocateTemperatureValues();
+    int changes = 0;
+    for (int y = 0; y < SIZE; ++y) {
+        int localY = localTop + y;
+        int first = localY * WorldChunk::CHUNK_SIZE + localLeft;
+        std::copy_n(&output[y * SIZE], SIZE, &temperatures[first]);
+
+        for (int x = 0; x < SIZE; ++x) {
+            ParticleType type = types[first + x];
+            if (type == ParticleType::EMPTY) continue;
+            ParticleType next = phaseChange(type, temperatures[first + x]);
+            if (next == type) continue;
+
+            // The new particle keeps the cell's temperature, except fire, which starts hot
+            int localX = localLeft + x;
+            chunk->setParticle(localX, localY, next);
+            chunk->setColor(localX, localY, randomParticleColor(next));
+            chunk->setVelocity(localX, localY, {0.0f, 0.0f});
+            chunk->setSettled(localX, localY, false);
+            chunk->setUpdateParity(localX, localY, frameParity);
+            if (next == ParticleType::FIRE) {
+                temperatures[first + x] = thermal[(int)ParticleType::FIRE].startTemperature;
+                chunk->setAttachmentGroup(localX, localY, 0);
+                chunk->setParticleAge(localX, localY, 0);
+                warm = true;
+            }
+
+            int pcX, pcY;
+            worldToParticleChunk(left + x, top + y, pcX, pcY);
+            particleChunkActivity.set(pcX, pcY);
+            changes++;
+        }
+    }
+
+    if (changes > 0) {
+        chunk->setSleeping(false);
+        chunk->setActive(true);
+        chunk->resetStableFrames();
+    }
+    if (warm) warmHeatTiles.set(tile.tileX, tile.tileY);
+    else warmHeatTiles.clear(tile.tileX, tile.tileY);
+    return changes;
+}
+
+void World::updateWetness() {
+    PROFILE_SCOPE("wetness");
+    int startPCX, startPCY, endPCX, endPCY;
+    getLoadedParticleChunkRange(startPCX, startPCY, endPCX, endPCY);
+
+    // New contacts where particles came to rest
+    for (int pcY = startPCY; pcY <= endPCY; ++pcY) {
+        for (int word = startPCX / BitGrid::WORD_BITS; word <= endPCX / BitGrid::WORD_BITS; ++word) {
+            uint64_t contacts = wetContactChunks.word(word, pcY) & BitGrid::columnMask(word, startPCX, endPCX);
+            BitGrid::forEachBit(contacts, word, [&](int pcX) { findWetContacts(pcX, pcY); });
+        }
+    }
+    wetContactChunks.fill(startPCX, startPCY, endPCX, endPCY, false);
+
+    // Cells found this update (or passed wetness last update) join at the end of the list
+    nextWetFrontier.clear();
+    for (const WetCell& cell : wetFrontier) {
+        if (updateWetCell(cell)) nextWetFrontier.push_back(cell);
+    }
+    std::swap(wetFrontier, nextWetFrontier);
+
+    PROFILE_COUNT("wet cells", (int)wetFrontier.size());
+}
+
+void World::findWetContacts(int pcX, int pcY) {
+    // The particle chunk and a ring of one cell around it: water resting at its edge may
+    // touch absorbent particles in the next particle chunk
+    int startX = std::max(pcX * PARTICLE_CHUNK_WIDTH - 1, 0);
+    int startY = std::max(pcY * PARTICLE_CHUNK_HEIGHT - 1, 0);
+    int endX = std::min((pcX + 1) * PARTICLE_CHUNK_WIDTH, WORLD_WIDTH - 1);
+    int endY = std::min((pcY + 1) * PARTICLE_CHUNK_HEIGHT, WORLD_HEIGHT - 1);
+
+    for (int y = startY; y <= endY; ++y) {
+        for (int x = startX; x <= endX; ++x) {
+            WorldChunk* chunk = findChunkAtWorldPos(x, y);
+            if (!chunk) continue;
+            int localX, localY;
+            worldToLocal(x, y, localX, localY);
+
+            float maxSaturation = getMaxSaturation(chunk->getParticle(localX, localY));
+            if (maxSaturation <= 0.0f || chunk->isOnWetFrontier(localX, localY)) continue;
+            if (chunk->getWetness(localX, localY) > maxSaturation - WETNESS_CONVERGED) continue;
+            if (!touchesWater(x, y)) continue;
+
+            chunk->setOnWetFrontier(localX, localY, true);
+            wetFrontier.push_back({x, y});
+        }
+    }
+}
+
+bool World::touchesWater(int worldX, int worldY) const {
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            if (dx == 0 && dy == 0) continue;
+            WorldChunk* chunk = findChunkAtWorldPos(worldX + dx, worldY + dy);
+            if (!chunk) continue;
+            int localX, localY;
+            worldToLocal(worldX + dx, worldY + dy, localX, localY);
+            if (chunk->getParticle(localX, localY) == ParticleType::WATER) return true;
+        }
+    }
+    return false;
+}
+
+bool World::updateWetCell(const WetCell& cell) {
+    // A cell whose chunk was unloaded simply drops out (the flag is not saved)
+    WorldChunk* chunk = findChunkAtWorldPos(cell.x, cell.y);
+    if (!chunk) return false;
+    int localX, localY;
+    worldToLocal(cell.x, cell.y, localX, localY);
+
+    // The particle may have moved away since the cell joined
+    float maxSaturation = getMaxSaturation(chunk->getParticle(localX, localY));
+    if (maxSaturation <= 0.0f) {
+        chunk->setOnWetFrontier(localX, localY, false);
+        return false;
+    }
+
+    float wetness = chunk->getWetness(localX, localY);
+    float change = 0.0f;
+
+    // Absorption from touching water (the water itself is not used up)
+    if (wetness < maxSaturation && touchesWater(cell.x, cell.y)) {
+        float absorbed = config.wetnessAbsorptionRate * (maxSaturation - wetness);
+        wetness += absorbed;
+        change += absorbed;
+    }
+
+    // Spreading to drier absorbent neighbours, which join the frontier
+    if (wetness > config.wetnessMinimumThreshold) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                if (dx == 0 && dy == 0) continue;
+                int nx = cell.x + dx;
+                int ny = cell.y + dy;
+                WorldChunk* neighbor = findChunkAtWorldPos(nx, ny);
+                if (!neighbor) continue;
+                int neighborX, neighborY;
+                worldToLocal(nx, ny, neighborX, neighborY);
+
+                float neighborSaturation = getMaxSaturation(neighbor->getParticle(neighborX, neighborY));
+                float neighborWetness = neighbor->getWetness(neighborX, neighborY);
+                if (neighborWetness >= neighborSaturation || wetness <= neighborWetness) continue;
+
+                float transfer = std::min((wetness - neighborWetness) * config.wetnessSpreadRate,
+                                          neighborSaturation - neighborWetness);
+                wetness -= transfer;
+                neighbor->setWetness(neighborX, neighborY, neighborWetness + transfer);
+                change += transfer;
+
+                if (transfer >= WETNESS_CONVERGED && !neighbor->isOnWetFrontier(neighborX, neighborY)) {
+                    neighbor->setOnWetFrontier(neighborX, neighborY, true);
+                    nextWetFrontier.push_back({nx, ny});
+                }
+            }
+        }
+    }
+
+    chunk->setWetness(localX, localY, wetness);
+    if (change < WETNESS_CONVERGED) {
+        chunk->setOnWetFrontier(localX, localY, false);
+        return false;
+    }
+    return true;
+}
+
+void World::update(float deltaTime) {
+    PROFILE_SCOPE("world update");
+    auto t0 = std::chrono::high_resolution_clock::now();
+
+    loadChunksAroundCamera();
+    unloadDistantChunks();
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    // Particles in flight move first, so those that land are simulated this tick
+    int ballisticLost = 0;
+    int ballisticLanded = updateBallistics(ballisticLost);
+
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    // Determine visible particle chunk range to simulate
+    int visWorldX_start, visWorldY_start, visWorldX_end, visWorldY_end;
+    getVisibleRegion(visWorldX_start, visWorldY_start, visWorldX_end, visWorldY_end);
+
+    int startPCX, startPCY, endPCX, endPCY;
+    worldToParticleChunk(visWorldX_start, visWorldY_start, startPCX, startPCY);
+    worldToParticleChunk(visWorldX_end - 1, visWorldY_end - 1, endPCX, endPCY);
+
+    // Simulate a border of 1 particle chunk around the visible area, out to whole tiles
+    int startTileX = std::max(0, startPCX - 1) / SIM_TILE_P_CHUNKS;
+    int startTileY = std::max(0, startPCY - 1) / SIM_TILE_P_CHUNKS;
+    int endTileX = std::min(P_CHUNKS_X - 1, endPCX + 1) / SIM_TILE_P_CHUNKS;
+    int endTileY = std::min(P_CHUNKS_Y - 1, endPCY + 1) / SIM_TILE_P_CHUNKS;
+    startPCX = startTileX * SIM_TILE_P_CHUNKS;
+    startPCY = startTileY * SIM_TILE_P_CHUNKS;
+    endPCX = std::min(P_CHUNKS_X - 1, endTileX * SIM_TILE_P_CHUNKS + SIM_TILE_P_CHUNKS - 1);
+    endPCY = std::min(P_CHUNKS_Y - 1, endTileY * SIM_TILE_P_CHUNKS + SIM_TILE_P_CHUNKS - 1);
+
+    // Cells stamped with this parity have been updated this frame
+    frameParity = !frameParity;
+    tickCount++;
+
+    int particlesUpdated = 0;
+    int chunksProcessed = 0;
+    int simTiles = 0;
+
+    // Bucket the tiles that hold awake particle chunks by checkerboard phase. The awake bits
+    // of each row of tiles are OR-ed together, so only tiles with awake chunks are visited.
+    for (auto& phase : simTilePhases) {
+        phase.clear();
+    }
+
+    for (int tileY = endTileY; tileY >= startTileY; --tileY) {
+        int tilePCY0 = tileY * SIM_TILE_P_CHUNKS;
+        int tilePCY1 = std::min(endPCY, tilePCY0 + SIM_TILE_P_CHUNKS - 1);
+        int lastTileX = -1;
+
+        for (int word = startPCX / BitGrid::WORD_BITS; word <= endPCX / BitGrid::WORD_BITS; ++word) {
+            uint64_t awake = 0;
+            for (int pcY = tilePCY0; pcY <= tilePCY1; ++pcY) {
+                awake |= awakeParticleChunks.word(word, pcY);
+            }
+            awake &= BitGrid::columnMask(word, startPCX, endPCX);
+
+            BitGrid::forEachBit(awake, word, [&](int pcX) {
+                int tileX = pcX / SIM_TILE_P_CHUNKS;
+                if (tileX == lastTileX) return;
+                lastTileX = tileX;
+                int phase = (tileX & 1) | ((tileY & 1) << 1);
+                simTilePhases[phase].push_back({tileX, tileY});
+                simTileLastTick[tileY * SIM_TILES_X + tileX] = (uint32_t)tickCount;
+                simTiles++;
+            });
+        }
+    }
+
+    auto t3 = std::chrono::high_resolution_clock::now();
+
+    particlesUpdated += runSimTilePhases(startPCX, startPCY, endPCX, endPCY, chunksProcessed);
+
     auto t4 = std::chrono::high_resolution_clock::now();
 
-    // DEBUG: Print every 600 calls
-    // if (callCount % 600 == 0) {
-    //     auto loadTime = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
-    //     auto fillTime = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
-    //     auto simTime = std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count();
-    //     auto sleepTime = std::chrono::duration_cast<std::chrono::microseconds>(t4 - t3).count();
-    //     std::cout << "[WORLD] call=" << callCount
-    //               << " | load=" << loadTime << "us"
-    //               << " | fill=" << fillTime << "us"
-    //               << " | sim=" << simTime << "us"
-    //               << " | sleep=" << sleepTime << "us"
-    //               << " | chunks=" << chunksProcessed
-    //               << " | particles=" << particlesUpdated << std::endl;
-    // }
+    // Update sleep states - ONLY for the tiles simulated above, not all chunks!
+    updateSleepStates(startPCX, startPCY, endPCX, endPCY);
+
+    auto t5 = std::chrono::high_resolution_clock::now();
+
+    // Heat over the same region, at a reduced rate
+    int heatTiles = 0;
+    int phaseChanges = 0;
+    int heatInterval = config.heatSimulationInterval;
+    if (heatInterval > 0 && tickCount % heatInterval == 0) {
+        heatTiles = updateHeat(startPCX * PARTICLE_CHUNK_WIDTH, startPCY * PARTICLE_CHUNK_HEIGHT,
+                               std::min(WORLD_WIDTH, (endPCX + 1) * PARTICLE_CHUNK_WIDTH) - 1,
+                               std::min(WORLD_HEIGHT, (endPCY + 1) * PARTICLE_CHUNK_HEIGHT) - 1, phaseChanges);
+    }
+
+    auto t6 = std::chrono::high_resolution_clock::now();
+
+    // The rest of the loaded area, at a reduced rate
+    updateOffscreenTiles(startTileX, startTileY, endTileX, endTileY, particlesUpdated, chunksProcessed);
+
+    auto t7 = std::chrono::high_resolution_clock::now();
+
+    updateWetness();
+
+    auto t8 = std::chrono::high_resolution_clock::now();
+
+    auto micros = [](auto from, auto to) { return std::chrono::duration<double, std::micro>(to - from).count(); };
+    PROFILE_COUNT("particles updated", particlesUpdated);
+    PROFILE_COUNT("particle chunks processed", chunksProcessed);
+    lastUpdateStats.particlesUpdated = particlesUpdated;
+    lastUpdateStats.particleChunksProcessed = chunksProcessed;
+    lastUpdateStats.simTiles = simTiles;
+    lastUpdateStats.loadMicros = micros(t0, t1);
+    lastUpdateStats.ballisticParticles = ballistics.size();
+    lastUpdateStats.ballisticLanded = ballisticLanded;
+    lastUpdateStats.ballisticLost = ballisticLost;
+    lastUpdateStats.ballisticMicros = micros(t1, t2);
+    lastUpdateStats.bucketMicros = micros(t2, t3);
+    lastUpdateStats.simMicros = micros(t3, t4);
+    lastUpdateStats.sleepMicros = micros(t4, t5);
+    lastUpdateStats.heatTiles = heatTiles;
+    lastUpdateStats.phaseChanges = phaseChanges;
+    lastUpdateStats.heatMicros = micros(t5, t6);
+    lastUpdateStats.offscreenMicros = micros(t6, t7);
+    lastUpdateStats.wetCells = (int)wetFrontier.size();
+    lastUpdateStats.wetnessMicros = micros(t7, t8);
 }
+
 bool World::loadSceneFromBMP(const std::string& filepath, int worldOffsetX, int worldOffsetY) {
     int imgWidth, imgHeight, channels;
     unsigned char* data = stbi_load(filepath.c_str(), &imgWidth, &imgHeight, &channels, 3);
@@ -1159,31 +2100,9 @@ bool World::loadSceneFromBMP(const std::string& filepath, int worldOffsetX, int
 
     std::cout << "Loading scene " << filepath << " (" << imgWidth << "x" << imgHeight << ")" << std::endl;
 
-    // Color mappings
-    struct ColorMapping {
-        int r, g, b;
-        ParticleType type;
-    };
-
-    std::vector<ColorMapping> colorMap = {
-        {255, 200, 100, ParticleType::SAND},
-        {50, 100, 255, ParticleType::WATER},
-        {128, 128, 128, ParticleType::ROCK},
-        {255, 100, 0, ParticleType::LAVA},
-        {240, 240, 240, ParticleType::STEAM},
-        {30, 20, 40, ParticleType::OBSIDIAN},
-        {255, 50, 0, ParticleType::FIRE},
-        {200, 230, 255, ParticleType::ICE},
-        {100, 180, 180, ParticleType::GLASS},
-        {139, 90, 43, ParticleType::WOOD},
-        {0, 150, 0, ParticleType::MOSS}
-    };
-
-    auto colorDistance = [](int r1, int g1, int b1, int r2, int g2, int b2) {
-        return (r1 - r2) * (r1 - r2) + (g1 - g2) * (g1 - g2) + (b1 - b2) * (b1 - b2);
-    };
+    // Same colours as scene images, with a looser match
+    ScenePalette palette(10, 5000);
 
-    int threshold = 5000;
     int particlesLoaded = 0;
 
     for (int iy = 0; iy < imgHeight; iy++) {
@@ -1198,19 +2117,10 @@ bool World::loadSceneFromBMP(const std::string& filepath, int worldOffsetX, int
             int g = data[pixelIdx + 1];
             int b = data[pixelIdx + 2];
 
-            if (r < 10 && g < 10 && b < 10) continue;
-
-            ParticleType bestMatch = ParticleType::EMPTY;
-            int bestDist = threshold;
-
-            for (const auto& cm : colorMap) {
-                int dist = colorDistance(r, g, b, cm.r, cm.g, cm.b);
-                if (dist < bestDist) {
-                    bestDist = dist;
-                    bestMatch = cm.type;
-                }
-            }
+            unsigned char match = palette.classify(r, g, b);
+            if (match == ScenePalette::JUMPER_MARKER) continue;
 
+            ParticleType bestMatch = (ParticleType)match;
             if (bestMatch != ParticleType::EMPTY) {
                 spawnParticleAt(worldX, worldY, bestMatch);
                 particlesLoaded++;
@@ -1224,16 +2134,7 @@ bool World::loadSceneFromBMP(const std::string& filepath, int worldOffsetX, int
 }
 
 int World::getParticleCount(ParticleType type) const {
-    int count = 0;
-    for (const auto& [key, chunk] : chunks) {
-        if (!chunk) continue;
-
-        const auto& particles = chunk->getParticleGrid();
-        for (const auto& p : particles) {
-            if (p == type) count++;
-        }
-    }
-    return count;
+    return particleTypeTotals[(int)type].load(std::memory_order_relaxed);
 }
 
 void World::addSceneObject(std::shared_ptr<SceneObject> obj) {
@@ -1277,6 +2178,10 @@ float World::getParticleMass(ParticleType type) const {
 }
 
 void World::explodeAt(int worldX, int worldY, int radius, float force) {
+    // The calling thread's generator was last reseeded for whichever tiles it happened to
+    // run; reseed it so the blast (and which cells fly off) is reproducible
+    Random::local().reseed(Random::hash(worldSeed, worldX, worldY, tickCount ^ EXPLOSION_SALT));
+
     // Set velocity on all particles in radius - physics system will move them
     for (int dy = -radius; dy <= radius; dy++) {
         for (int dx = -radius; dx <= radius; dx++) {
@@ -1323,23 +2228,25 @@ void World::explodeAt(int worldX, int worldY, int radius, float force) {
             float dirY = (dist > 0.1f) ? dy / dist : -1.0f;
 
             // Add randomness
-            float randAngle = ((std::rand() % 100) - 50) / 100.0f * 0.6f;
+            float randAngle = Random::local().range(-50, 49) / 100.0f * 0.6f;
             float cosA = std::cos(randAngle);
             float sinA = std::sin(randAngle);
             float newDirX = dirX * cosA - dirY * sinA;
             float newDirY = dirX * sinA + dirY * cosA;
 
-            float randForce = 0.7f + ((std::rand() % 60) / 100.0f);
+            float randForce = 0.7f + Random::local().below(60) / 100.0f;
 
-            // Set velocity - scaled by inverse mass (lighter = faster)
-            ParticleVelocity vel;
-            vel.vx = newDirX * force * falloff * randForce * massMultiplier;
-            vel.vy = newDirY * force * falloff * randForce * massMultiplier;
+            // Velocity in cells per tick - scaled by inverse mass (lighter = faster)
+            float vx = newDirX * force * falloff * randForce * massMultiplier;
+            float vy = newDirY * force * falloff * randForce * massMultiplier;
+            float speed = std::sqrt(vx * vx + vy * vy);
+            if (speed > BALLISTIC_MAX_SPEED) {
+                vx *= BALLISTIC_MAX_SPEED / speed;
+                vy *= BALLISTIC_MAX_SPEED / speed;
+            }
 
-            chunk->setVelocity(localX, localY, vel);
-            chunk->setExploding(localX, localY, true);  // Set exploding mode
-            // Random timeout: -60 to -30 frames = 500-1000ms at 60fps, deleted when age >= 0
-            chunk->setParticleAge(localX, localY, -(30 + (std::rand() % 31)));
+            // Slower particles stay in the grid and are only woken up
+            if (speed >= BALLISTIC_MIN_SPEED) launchParticle(px, py, vx, vy);
 
             // Wake chunk
             chunk->setSleeping(false);
@@ -1347,6 +2254,217 @@ void World::explodeAt(int worldX, int worldY, int radius, float force) {
             chunk->resetStableFrames();
         }
     }
+
+    // Wake the particle chunks in the blast: settled terrain around the crater has to fall
+    int startPCX, startPCY, endPCX, endPCY;
+    worldToParticleChunk(std::max(0, worldX - radius), std::max(0, worldY - radius), startPCX, startPCY);
+    worldToParticleChunk(std::min(WORLD_WIDTH - 1, worldX + radius), std::min(WORLD_HEIGHT - 1, worldY + radius), endPCX, endPCY);
+    wakeParticleChunks(startPCX, startPCY, endPCX, endPCY);
+}
+
+void World::launchParticle(int worldX, int worldY, float vx, float vy) {
+    WorldChunk* chunk = findChunkAtWorldPos(worldX, worldY);
+    if (!chunk) return;
+    int localX, localY;
+    worldToLocal(worldX, worldY, localX, localY);
+
+    ParticleType type = chunk->getParticle(localX, localY);
+    if (type == ParticleType::EMPTY) return;
+    ballistics.add(worldX + 0.5f, worldY + 0.5f, vx, vy, type,
+                   chunk->getColor(localX, localY), chunk->getTemperature(localX, localY));
+
+    // The chunk's histogram loses the particle; the world totals keep it while it flies
+    chunk->setParticle(localX, localY, ParticleType::EMPTY);
+    particleTypeTotals[(int)type].fetch_add(1, std::memory_order_relaxed);
+    chunk->setColor(localX, localY, {0, 0, 0});
+    chunk->setVelocity(localX, localY, {0, 0});
+    chunk->setAttachmentGroup(localX, localY, 0);
+    markRenderDirty(worldX, worldY);
+
+    int pcX, pcY;
+    worldToParticleChunk(worldX, worldY, pcX, pcY);
+    particleChunkActivity.set(pcX, pcY);
+}
+
+int World::updateBallistics(int& lost) {
+    PROFILE_SCOPE("ballistics");
+    int landed = 0;
+    lost = 0;
+
+    for (int i = 0; i < ballistics.size();) {
+        float& vx = ballistics.vx[i];
+        float& vy = ballistics.vy[i];
+        vy += config.particleFallAcceleration;
+        vx *= 1.0f - config.airResistance;
+        vy *= 1.0f - config.airResistance;
+        vx = std::clamp(vx, -BALLISTIC_MAX_SPEED, BALLISTIC_MAX_SPEED);
+        vy = std::clamp(vy, -BALLISTIC_MAX_SPEED, BALLISTIC_MAX_SPEED);
+
+        // March along this tick's path one cell at a time along the longer axis
+        float x0 = ballistics.x[i];
+        float y0 = ballistics.y[i];
+        int steps = (int)std::ceil(std::max(std::abs(vx), std::abs(vy)));
+        int lastX = (int)x0;
+        int lastY = (int)y0;
+        bool gone = !findChunkAtWorldPos(lastX, lastY);  // Its chunk was unloaded
+        bool hit = false;
+
+        for (int step = 1; step <= steps && !gone; ++step) {
+            float t = (float)step / steps;
+            int cellX = (int)std::floor(x0 + vx * t);
+            int cellY = (int)std::floor(y0 + vy * t);
+            if (cellX == lastX && cellY == lastY) continue;
+
+            // Leaving the world or the loaded area: the particle is gone
+            WorldChunk* chunk = findChunkAtWorldPos(cellX, cellY);
+            if (!chunk) {
+                gone = true;
+                break;
+            }
+            int localX, localY;
+            worldToLocal(cellX, cellY, localX, localY);
+            if (chunk->getParticle(localX, localY) != ParticleType::EMPTY || isBlockedBySceneObject(cellX, cellY)) {
+                hit = true;
+                break;
+            }
+            lastX = cellX;
+            lastY = cellY;
+        }
+
+        if (gone) {
+            particleTypeTotals[(int)ballistics.type[i]].fetch_sub(1, std::memory_order_relaxed);
+            lost++;
+            ballistics.remove(i);
+            continue;
+        }
+        if (hit && landBallistic(i, lastX, lastY)) {
+            landed++;
+            ballistics.remove(i);
+            continue;
+        }
+
+        // Boxed in by particles that landed before it: wait where it is for room to open up
+        if (hit) {
+            vx = 0.0f;
+            vy = 0.0f;
+            i++;
+            continue;
+        }
+
+        ballistics.x[i] = x0 + vx;
+        ballistics.y[i] = y0 + vy;
+        i++;
+    }
+
+    PROFILE_COUNT("ballistic particles", ballistics.size());
+    return landed;
+}
+
+bool World::landBallistic(int index, int worldX, int worldY) {
+    // The last free cell on the path may have been taken by a particle that landed before
+    // this one: try the rings around it, upper rows first
+    for (int radius = 0; radius <= BALLISTIC_LANDING_SEARCH; ++radius) {
+        for (int y = worldY - radius; y <= worldY + radius; ++y) {
+            for (int x = worldX - radius; x <= worldX + radius; ++x) {
+                if (std::max(std::abs(x - worldX), std::abs(y - worldY)) != radius) continue;
+                if (placeBallistic(index, x, y)) return true;
+            }
+        }
+    }
+
+    // Buried where the crater filled in: it heaps up on the surface above
+    for (int y = worldY - BALLISTIC_LANDING_SEARCH - 1; y >= worldY - BALLISTIC_SURFACE_SEARCH; --y) {
+        if (placeBallistic(index, worldX, y)) return true;
+    }
+    return false;
+}
+
+bool World::placeBallistic(int index, int worldX, int worldY) {
+    WorldChunk* chunk = findChunkAtWorldPos(worldX, worldY);
+    if (!chunk) return false;
+    int localX, localY;
+    worldToLocal(worldX, worldY, localX, localY);
+    if (chunk->getParticle(localX, localY) != ParticleType::EMPTY || isBlockedBySceneObject(worldX, worldY)) return false;
+
+    float temperature = ballistics.temperature[index];
+    chunk->setParticle(localX, localY, ballistics.type[index]);
+    particleTypeTotals[(int)ballistics.type[index]].fetch_sub(1, std::memory_order_relaxed);  // Counted in flight until now
+    chunk->setColor(localX, localY, ballistics.color[index]);
+    chunk->setTemperature(localX, localY, temperature);
+    chunk->setSettled(localX, localY, false);
+    chunk->setUpdateParity(localX, localY, frameParity);
+    markRenderDirty(worldX, worldY);
+    if (!isAmbient(temperature)) markWarm(worldX, worldY);
+
+    wakeChunkAtWorldPos(worldX, worldY);
+    int pcX, pcY;
+    worldToParticleChunk(worldX, worldY, pcX, pcY);
+    wakeParticleChunks(pcX, pcY, pcX, pcY);
+    return true;
+}
+
+bool World::raycast(float x0, float y0, float x1, float y1, RaycastHit& hit) const {
+    float dx = x1 - x0;
+    float dy = y1 - y0;
+    float length = std::sqrt(dx * dx + dy * dy);
+    if (length <= 0.0f) return false;
+
+    // Amanatides-Woo: t runs from 0 to 1 along the segment. tMax is where the next vertical
+    // (x) or horizontal (y) cell boundary is crossed, tDelta how much t one cell takes.
+    int cellX = (int)std::floor(x0);
+    int cellY = (int)std::floor(y0);
+    int endX = (int)std::floor(x1);
+    int endY = (int)std::floor(y1);
+    int stepX = dx > 0.0f ? 1 : (dx < 0.0f ? -1 : 0);
+    int stepY = dy > 0.0f ? 1 : (dy < 0.0f ? -1 : 0);
+    float tDeltaX = stepX != 0 ? 1.0f / std::abs(dx) : INFINITY;
+    float tDeltaY = stepY != 0 ? 1.0f / std::abs(dy) : INFINITY;
+    float tMaxX = stepX > 0 ? (cellX + 1 - x0) * tDeltaX : (stepX < 0 ? (x0 - cellX) * tDeltaX : INFINITY);
+    float tMaxY = stepY > 0 ? (cellY + 1 - y0) * tDeltaY : (stepY < 0 ? (y0 - cellY) * tDeltaY : INFINITY);
+
+    // The chunk's cells are looked up again only when the walk crosses into another chunk
+    const ParticleType* grid = nullptr;
+    int chunkX = -1, chunkY = -1;
+
+    int cells = std::abs(endX - cellX) + std::abs(endY - cellY);
+    for (int n = 0; n < cells; ++n) {
+        // Rounding must not carry the walk past the end cell on either axis
+        float t;
+        if (cellY == endY || (cellX != endX && tMaxX < tMaxY)) {
+            cellX += stepX;
+            t = tMaxX;
+            tMaxX += tDeltaX;
+            hit.normalX = -stepX;
+            hit.normalY = 0;
+        } else {
+            cellY += stepY;
+            t = tMaxY;
+            tMaxY += tDeltaY;
+            hit.normalX = 0;
+            hit.normalY = -stepY;
+        }
+
+        if (!inWorldBounds(cellX, cellY)) return false;
+        int cx = cellX / WorldChunk::CHUNK_SIZE;
+        int cy = cellY / WorldChunk::CHUNK_SIZE;
+        if (cx != chunkX || cy != chunkY) {
+            const WorldChunk* chunk = findChunk(cx, cy);
+            grid = chunk ? chunk->getParticleGrid().data() : nullptr;
+            chunkX = cx;
+            chunkY = cy;
+        }
+        if (!grid) continue;
+
+        int localX = cellX - cx * WorldChunk::CHUNK_SIZE;
+        int localY = cellY - cy * WorldChunk::CHUNK_SIZE;
+        if (grid[localY * WorldChunk::CHUNK_SIZE + localX] != ParticleType::EMPTY) {
+            hit.cellX = cellX;
+            hit.cellY = cellY;
+            hit.distance = std::min(t, 1.0f) * length;
+            return true;
+        }
+    }
+    return false;
 }
 
 bool World::isSolidParticle(ParticleType type) const {
@@ -1445,17 +2563,15 @@ bool World::checkCapsuleCollision(float centerX, float centerY, float radius, fl
 }
 
 
-void World::procedurallyGenerateMoss(WorldChunk* chunk) {
-    if (!chunk) return;
-
+void World::procedurallyGenerateMoss(ChunkCanvas& canvas) const {
     // A time limit for generation to stop after a few seconds from the start of the program
     // static std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
     // if (std::chrono::steady_clock::now() - start_time > std::chrono::seconds(2)) {
     //     return;
     // }
 
-    int chunkWorldX = chunk->getWorldX();
-    int chunkWorldY = chunk->getWorldY();
+    int chunkWorldX = canvas.getChunk().getWorldX();
+    int chunkWorldY = canvas.getChunk().getWorldY();
 
     for (int y = 0; y < WorldChunk::CHUNK_SIZE; ++y) {
         for (int x = 0; x < WorldChunk::CHUNK_SIZE; ++x) {
@@ -1463,10 +2579,10 @@ void World::procedurallyGenerateMoss(WorldChunk* chunk) {
             int worldY = chunkWorldY + y;
 
             // If this particle is rock and the one above it is empty
-            if (getParticle(worldX, worldY) == ParticleType::ROCK && getParticle(worldX, worldY - 1) == ParticleType::EMPTY) {
-                if (std::rand() % 10 < 1) {
-                    int width = 2 + std::rand() % 8;
-                    int depth = 1 + std::rand() % 4;
+            if (canvas.getParticle(worldX, worldY) == ParticleType::ROCK && canvas.getParticle(worldX, worldY - 1) == ParticleType::EMPTY) {
+                if (Random::local().below(10) == 0) {
+                    int width = Random::local().range(2, 9);
+                    int depth = Random::local().range(1, 4);
 
                     // for the depth we want to make the moss
                     for (int py = -1; py < depth; ++py) {
@@ -1477,18 +2593,19 @@ void World::procedurallyGenerateMoss(WorldChunk* chunk) {
                             int mossY = worldY + py;
 
                             // generate the moss, replace the rock particles if they're on it
+                            // (the canvas clips patches to the chunk being generated)
                             if (inWorldBounds(mossX, mossY)) {
-                                ParticleType existingParticle = getParticle(mossX, mossY);
+                                ParticleType existingParticle = canvas.getParticle(mossX, mossY);
                                 if (existingParticle == ParticleType::ROCK) {
-                                    setParticle(mossX, mossY, ParticleType::MOSS);
-                                    setColor(mossX, mossY, generateRandomColor(config.moss.colorR, config.moss.colorG, config.moss.colorB, config.moss.colorVariation));
+                                    canvas.setParticle(mossX, mossY, ParticleType::MOSS);
+                                    canvas.setColor(mossX, mossY, generateRandomColor(config.moss.colorR, config.moss.colorG, config.moss.colorB, config.moss.colorVariation));
 
                                 // some particles grow above the rock
                                 } else if (existingParticle == ParticleType::EMPTY) {
-                                    ParticleType particleBelow = getParticle(mossX, mossY + 1);
+                                    ParticleType particleBelow = canvas.getParticle(mossX, mossY + 1);
                                     if (particleBelow == ParticleType::ROCK || particleBelow == ParticleType::MOSS) {
-                                        setParticle(mossX, mossY, ParticleType::MOSS);
-                                        setColor(mossX, mossY, generateRandomColor(config.moss.colorR, config.moss.colorG, config.moss.colorB, config.moss.colorVariation));
+                                        canvas.setParticle(mossX, mossY, ParticleType::MOSS);
+                                        canvas.setColor(mossX, mossY, generateRandomColor(config.moss.colorR, config.moss.colorG, config.moss.colorB, config.moss.colorVariation));
                                     }
                                 }
                             }
@@ -1,9 +1,14 @@
 #pragma once
 #include "SandSimulator.h"  // For ParticleType, ParticleColor, ParticleVelocity
 #include "WorldChunk.h"
+#include "RegionStore.h"
+#include "ChunkCanvas.h"
 #include "SceneObject.h"
 #include "Config.h"
+#include "BitGrid.h"
+#include "BallisticParticles.h"
 #include <unordered_map>
+#include <atomic>
 #include <memory>
 #include <string>
 #include <functional>
@@ -34,13 +39,25 @@ struct Camera {
     // Target tracking
     float targetX, targetY; // Where camera wants to be
 
+    // Smoothed velocity (pixels per second), used to prefetch chunks ahead of the camera
+    float velocityX, velocityY;
+
     Camera() : x(0), y(0), viewportWidth(12), viewportHeight(12), moveSpeed(25.0f),
                deadzoneWidth(200.0f), deadzoneHeight(120.0f),
                smoothSpeed(4.0f),
                lookAheadX(0), lookAheadY(0),
                lookAheadMaxX(80.0f), lookAheadMaxY(50.0f),
                lookAheadSpeed(2.0f),
-               targetX(0), targetY(0) {}
+               targetX(0), targetY(0),
+               velocityX(0), velocityY(0) {}
+
+    // Fold the movement since (prevX, prevY) into the smoothed velocity
+    void trackVelocity(float prevX, float prevY, float deltaTime) {
+        if (deltaTime <= 0.0f) return;
+        float blend = 1.0f - std::exp(-8.0f * deltaTime);
+        velocityX += ((x - prevX) / deltaTime - velocityX) * blend;
+        velocityY += ((y - prevY) / deltaTime - velocityY) * blend;
+    }
 
     // Update camera to follow a target position with movement direction
     void update(float playerX, float playerY, float playerWidth, float playerHeight,
@@ -50,6 +67,8 @@ struct Camera {
         // Calculate player center
         float playerCenterX = playerX + playerWidth / 2.0f;
         float playerCenterY = playerY + playerHeight / 2.0f;
+        float prevX = x;
+        float prevY = y;
 
         // Calculate current camera center
         float camCenterX = x + viewportWidth / 2.0f;
@@ -107,6 +126,8 @@ struct Camera {
         // Final clamp to ensure camera never goes out of bounds
         x = std::max(0.0f, std::min(x, maxCamX));
         y = std::max(0.0f, std::min(y, maxCamY));
+
+        trackVelocity(prevX, prevY, deltaTime);
     }
 
     // Instant center on position (for initialization)
@@ -122,6 +143,8 @@ struct Camera {
 
         targetX = x;
         targetY = y;
+        velocityX = 0;
+        velocityY = 0;
     }
 };
 
@@ -140,9 +163,21 @@ struct ChunkKeyHash {
     }
 };
 
-struct ParticleChunk {
-    bool isAwake = true;
-    int stableFrames = 0;
+
+// 3x3 block of chunk pointers around one chunk. Resolved once per simulation tile so
+// the cell loop can reach the tile's chunk and its neighbours without any lookup.
+struct ChunkNeighborhood {
+    int originChunkX = 0;  // Chunk at the centre of the block
+    int originChunkY = 0;
+    WorldChunk* chunks[3][3] = {};
+
+    // Chunk holding a world cell, or nullptr if it is outside the block or not loaded
+    WorldChunk* at(int worldX, int worldY) const {
+        int dx = worldX / WorldChunk::CHUNK_SIZE - originChunkX + 1;
+        int dy = worldY / WorldChunk::CHUNK_SIZE - originChunkY + 1;
+        if (dx < 0 || dx > 2 || dy < 0 || dy > 2) return nullptr;
+        return chunks[dy][dx];
+    }
 };
 
 // Enemy spawn marker types (detected from level image colors)
@@ -158,6 +193,47 @@ struct EnemySpawnPoint {
 };
 
 
+// Work done by the last World::update
+struct WorldUpdateStats {
+    int particlesUpdated = 0;
+    int particleChunksProcessed = 0;
+    int simTiles = 0;          // Tiles with awake particle chunks
+    int offscreenTiles = 0;    // Off-screen tiles updated at the reduced rate
+    int offscreenDeferred = 0; // Off-screen tiles due but left for a later tick (over budget)
+    double loadMicros = 0.0;   // Loading/unloading chunks around the camera
+    double bucketMicros = 0.0; // Finding the tiles with awake particle chunks
+    double simMicros = 0.0;    // Particle updates, all phases
+    double sleepMicros = 0.0;  // Particle chunk sleep/wake
+    double offscreenMicros = 0.0; // Off-screen tiles, including their sleep/wake
+    int heatTiles = 0;         // Tiles swept by the heat pass (0 on ticks without one)
+    int phaseChanges = 0;      // Cells it melted, froze, boiled, condensed or ignited
+    double heatMicros = 0.0;   // Heat diffusion and phase changes
+    int wetCells = 0;          // Cells left on the wetness frontier
+    double wetnessMicros = 0.0; // Wetness contacts and frontier
+    int ballisticParticles = 0; // Particles in flight after the update
+    int ballisticLanded = 0;   // Particles that landed back in the grid
+    int ballisticLost = 0;     // Particles that flew out of the world or the loaded chunks
+    double ballisticMicros = 0.0; // Flight, collisions and landing
+};
+
+class ChunkGenerator;
+class ScenePalette;
+class LevelFile;
+
+// A chunk built off the main thread, waiting to be published into the world
+struct GeneratedChunk {
+    std::unique_ptr<WorldChunk> chunk;
+    std::vector<EnemySpawnPoint> spawnPoints;  // Markers found while populating from the scene
+    bool populatedFromScene = false;
+};
+
+// First occupied cell found by World::raycast
+struct RaycastHit {
+    int cellX = 0, cellY = 0;
+    int normalX = 0, normalY = 0;  // Outward normal of the face the ray entered through
+    float distance = 0.0f;         // Along the ray from its start to that face
+};
+
 class World {
 public:
     // World size in chunks (70x70 = 35,840 x 35,840 pixels)
@@ -173,9 +249,50 @@ public:
     static constexpr int P_CHUNKS_Y = (WORLD_HEIGHT + PARTICLE_CHUNK_HEIGHT - 1) / PARTICLE_CHUNK_HEIGHT;
     static constexpr int P_CHUNK_FRAMES_UNTIL_SLEEP = 15;
 
+    // Parallel update tiles: square groups of particle chunks swept in a 4-phase
+    // checkerboard, so two tiles updated at the same time are always a full tile apart.
+    // Particle rules may reach at most SIM_TILE_SIZE / 2 cells outside their own tile.
+    static constexpr int SIM_TILE_P_CHUNKS = 4;
+    static constexpr int SIM_TILE_SIZE = SIM_TILE_P_CHUNKS * PARTICLE_CHUNK_WIDTH;  // 40x40 cells
+    static constexpr int SIM_TILES_X = (P_CHUNKS_X + SIM_TILE_P_CHUNKS - 1) / SIM_TILE_P_CHUNKS;
+    static constexpr int SIM_TILES_Y = (P_CHUNKS_Y + SIM_TILE_P_CHUNKS - 1) / SIM_TILE_P_CHUNKS;
+
+    // Tiles around the view are updated every tick; other tiles of the loaded area every
+    // config.offscreenSimulationInterval ticks or more, OFFSCREEN_BATCH_TILES at a time
+    // until the tick's time budget runs out
+    static constexpr int OFFSCREEN_BATCH_TILES = 16;
+
+
+    // Render tiles: squares the viewport renderer redraws when a cell's type or colour changes
+    static constexpr int RENDER_TILE_SIZE = 32;
+    static constexpr int RENDER_TILES_X = WORLD_WIDTH / RENDER_TILE_SIZE;
+    static constexpr int RENDER_TILES_Y = WORLD_HEIGHT / RENDER_TILE_SIZE;
+    static constexpr int FIRE_GLOW_HEIGHT = 3;  // Cells above a fire cell its glow reaches
+
+    // Heat tiles: squares of the temperature planes swept by the heat pass every
+    // config.heatSimulationInterval ticks. Only tiles that may hold a particle away from
+    // ambient temperature, and the tiles around them, are visited.
+    static constexpr int HEAT_TILE_SIZE = 32;
+    static constexpr int HEAT_TILES_X = WORLD_WIDTH / HEAT_TILE_SIZE;
+    static constexpr int HEAT_TILES_Y = WORLD_HEIGHT / HEAT_TILE_SIZE;
+    static constexpr float AMBIENT_TEMPERATURE = 20.0f;  // Default of the chunk temperature plane
+    static constexpr float AMBIENT_TOLERANCE = 0.5f;     // Closer than this counts as ambient
+
+    // Wetness changes smaller than this in an update count as converged
+    static constexpr float WETNESS_CONVERGED = 0.001f;
+
+    // Ballistic particles: explosions lift cells moving at least BALLISTIC_MIN_SPEED cells
+    // per tick out of the grid; they fly until they hit something and land in the last free
+    // cell on their path, the nearest free cell up to BALLISTIC_LANDING_SEARCH cells away or,
+    // when buried, the first free cell up to BALLISTIC_SURFACE_SEARCH cells above
+    static constexpr float BALLISTIC_MIN_SPEED = 1.0f;
+    static constexpr float BALLISTIC_MAX_SPEED = 10.0f;
+    static constexpr int BALLISTIC_LANDING_SEARCH = 4;
+    static constexpr int BALLISTIC_SURFACE_SEARCH = 64;
 
     // How many chunks around the camera to keep loaded/active
     static constexpr int LOAD_RADIUS = 3;      // Load chunks within this radius
+    static constexpr int PREFETCH_RADIUS = LOAD_RADIUS + 1;  // Generate chunks the camera is about to reach out to here
 
     World(const Config& config);
     ~World();  // Need destructor to free scene image
@@ -199,6 +316,8 @@ public:
 
     // Simulation
     void update(float deltaTime);
+    const WorldUpdateStats& getLastUpdateStats() const { return lastUpdateStats; }
+    uint64_t getSeed() const { return worldSeed; }
 
     // Chunk management
     WorldChunk* getChunk(int chunkX, int chunkY);
@@ -206,6 +325,20 @@ public:
     WorldChunk* getChunkAtWorldPos(int worldX, int worldY);
     const WorldChunk* getChunkAtWorldPos(int worldX, int worldY) const;
 
+    // Chunk lookups through the flat chunk table - never create chunks, so they are
+    // safe to call from simulation worker threads
+    WorldChunk* findChunk(int chunkX, int chunkY) const {
+        if (chunkX < 0 || chunkX >= WORLD_CHUNKS_X || chunkY < 0 || chunkY >= WORLD_CHUNKS_Y) {
+            return nullptr;
+        }
+        return chunkTable[chunkY * WORLD_CHUNKS_X + chunkX];
+    }
+    WorldChunk* findChunkAtWorldPos(int worldX, int worldY) const {
+        if (!inWorldBounds(worldX, worldY)) return nullptr;
+        return chunkTable[(worldY / WorldChunk::CHUNK_SIZE) * WORLD_CHUNKS_X + worldX / WorldChunk::CHUNK_SIZE];
+    }
+    void getChunkNeighborhood(int chunkX, int chunkY, ChunkNeighborhood& out) const;
+
     void loadChunksAroundCamera();
     void unloadDistantChunks();
 
@@ -220,6 +353,18 @@ public:
 
     // Scene loading - lazy load from image as chunks come into view
     bool setSceneImage(const std::string& filepath);
+
+    // Same, from a level baked with level_bake (memory-mapped, no image decoding)
+    bool setSceneLevel(const std::string& filepath);
+
+    // Terrain the scene places at a world cell (EMPTY outside the image, for dark
+    // background pixels and for spawn markers)
+    ParticleType getSceneParticle(int worldX, int worldY) const;
+
+    // Build a chunk's initial contents (scene terrain, moss, textures) into a new chunk.
+    // Reads only the scene image and config, so generation threads may call it.
+    std::unique_ptr<WorldChunk> generateChunk(int chunkX, int chunkY, bool populateFromScene,
+                                              std::vector<EnemySpawnPoint>& spawnPoints) const;
     bool loadSceneFromBMP(const std::string& filepath, int worldOffsetX = 0, int worldOffsetY = 0);
 
     // Rendering helpers
@@ -230,9 +375,12 @@ public:
     // Get visible region in world coordinates
     void getVisibleRegion(int& startX, int& startY, int& endX, int& endY) const;
 
-    // Particle counts
+    // Particles of a type in the loaded chunks, plus those in flight (kept incrementally, no scan)
     int getParticleCount(ParticleType type) const;
 
+    // Whether a render tile changed since the last call for it; clears the tile's flag
+    bool takeRenderDirty(int tileX, int tileY) { return renderDirty.take(tileX, tileY); }
+
     // Config access
     const Config& getConfig() const { return config; }
 
@@ -243,7 +391,7 @@ public:
 
     const std::unordered_map<ChunkKey, std::unique_ptr<WorldChunk>, ChunkKeyHash>& getChunks() const { return chunks; }
 
-    const std::vector<ParticleChunk>& getParticleChunks() const { return particleChunks; }
+    bool isParticleChunkAwake(int pcX, int pcY) const { return awakeParticleChunks.test(pcX, pcY); }
 
     // Enemy spawn points detected from level image markers
     std::vector<EnemySpawnPoint>& getEnemySpawnPoints() { return enemySpawnPoints; }
@@ -252,8 +400,9 @@ public:
     // Check if a world position is blocked by a scene object
     bool isBlockedBySceneObject(int worldX, int worldY) const;
 
-    // Explode particles in a radius - unsettles them and applies outward velocity
+    // Explode particles in a radius: those pushed fast enough fly off as ballistic particles
     void explodeAt(int worldX, int worldY, int radius, float force);
+    const BallisticParticles& getBallistics() const { return ballistics; }
 
     // Get mass of a particle type (for explosion scaling)
     float getParticleMass(ParticleType type) const;
@@ -262,6 +411,11 @@ public:
     bool isSolidParticle(ParticleType type) const;
     bool checkCapsuleCollision(float centerX, float centerY, float radius, float height, float& collisionY) const;
 
+    // Walk the cells the segment (x0, y0) -> (x1, y1) crosses, in order, and stop at the first
+    // occupied one. The cell the segment starts in is not tested. False if there is none
+    // before the end, or the segment leaves the world first.
+    bool raycast(float x0, float y0, float x1, float y1, RaycastHit& hit) const;
+
 private:
     Config config;
     Camera camera;
@@ -269,9 +423,80 @@ private:
     // Loaded chunks (sparse storage - only chunks that exist are stored)
     std::unordered_map<ChunkKey, std::unique_ptr<WorldChunk>, ChunkKeyHash> chunks;
 
-    // Particle chunk management for sleeping
-    std::vector<ParticleChunk> particleChunks;
-    std::vector<bool> particleChunkActivity;
+    // Distant non-empty chunks are evicted here and restored when the camera returns
+    std::unique_ptr<RegionStore> regionStore;
+
+    // Builds chunks of the load ring in the background (null = generate synchronously)
+    std::unique_ptr<ChunkGenerator> chunkGenerator;
+    std::vector<GeneratedChunk> generatedChunks;  // Reused between frames
+
+    // Flat WORLD_CHUNKS_X * WORLD_CHUNKS_Y index into chunks (non-owning, nullptr = not loaded).
+    // Kept in sync wherever chunks are inserted or erased.
+    std::vector<WorldChunk*> chunkTable;
+
+    // Per-type cell totals over the loaded chunks. Chunks are attached when published and
+    // detached when unloaded, and report every type change in between.
+    std::atomic<int> particleTypeTotals[PARTICLE_TYPE_COUNT];
+
+    // Particle chunk sleeping. Only awake particle chunks are simulated; one falls asleep
+    // after P_CHUNK_FRAMES_UNTIL_SLEEP updates without movement, and movement wakes it and
+    // its neighbours. Chunks start asleep; publishing a world chunk wakes those holding
+    // particles that can move.
+    BitGrid awakeParticleChunks{P_CHUNKS_X, P_CHUNKS_Y};
+    BitGrid particleChunkActivity{P_CHUNKS_X, P_CHUNKS_Y};  // Movement this update (set from worker threads)
+    std::vector<unsigned char> particleChunkStableFrames;   // Updates without movement, per awake chunk
+    std::vector<uint64_t> sleepActivityRows;                // Scratch for updateSleepStates
+
+    // Bit per render tile, set when a cell's type or colour changes (also from worker threads)
+    BitGrid renderDirty{RENDER_TILES_X, RENDER_TILES_Y};
+
+    // Simulation tiles for the current frame, bucketed by checkerboard phase
+    struct SimTile {
+        int tileX, tileY;
+    };
+    std::vector<SimTile> simTilePhases[4];
+    std::vector<uint32_t> simTileLastTick;  // Tick each tile was last updated (0 = never)
+    std::vector<SimTile> offscreenDue;      // Scratch for updateOffscreenTiles
+
+    // Heat, per particle type (EMPTY has no conductivity and no transfer, so empty cells
+    // take no part in diffusion)
+    struct ThermalProperties {
+        float conductivity;
+        float transferScale;     // energyConversionFactor / 2 / heatCapacity
+        float startTemperature;  // Given to placed and generated particles
+        float meltingPoint, boilingPoint;
+    };
+    ThermalProperties thermal[PARTICLE_TYPE_COUNT];
+
+    // Heat tiles that may hold a particle away from ambient temperature. Set wherever a
+    // particle is given or carries such a temperature (from worker threads too), cleared by
+    // the heat pass once every particle in the tile is back at ambient.
+    BitGrid warmHeatTiles{HEAT_TILES_X, HEAT_TILES_Y};
+    struct HeatTile {
+        int tileX, tileY;
+    };
+    std::vector<HeatTile> heatTileList;  // Scratch for updateHeat
+    std::vector<float> heatOutput;       // New temperatures, HEAT_TILE_SIZE^2 per listed tile
+    std::vector<int> heatTileChanges;    // Phase changes per listed tile
+
+    // Wetness. Only cells on the frontier are updated: absorbent cells soaking up water or
+    // passing wetness on to drier neighbours. Particle chunks where water came to rest are
+    // searched for new contacts; a cell leaves the frontier once its wetness stops changing.
+    // Frontier cells carry WorldChunk::FLAG_WET_FRONTIER.
+    BitGrid wetContactChunks{P_CHUNKS_X, P_CHUNKS_Y};  // Set from worker threads
+    struct WetCell {
+        int x, y;
+    };
+    std::vector<WetCell> wetFrontier;
+    std::vector<WetCell> nextWetFrontier;
+
+    BallisticParticles ballistics;  // In flight, outside the grid
+
+    // Flips every frame; matched against each cell's update parity bit
+    bool frameParity = false;
+    uint64_t worldSeed = 0;
+    uint64_t tickCount = 0;   // World::update calls, part of each tile's random seed
+    WorldUpdateStats lastUpdateStats;
 
     // Scene objects (non-particle entities)
     std::vector<std::shared_ptr<SceneObject>> sceneObjects;
@@ -281,6 +506,45 @@ private:
 
     // Simulation helpers
     void updateParticle(int worldX, int worldY);
+    int updateSimTile(const SimTile& tile, int startPCX, int startPCY, int endPCX, int endPCY, int& chunksProcessed);
+    int updateParticleChunk(int pcX, int pcY, const ChunkNeighborhood& neighborhood);
+    void wakeParticleChunks(int startPCX, int startPCY, int endPCX, int endPCY);  // Inclusive, clipped
+    void stampWokenParticleChunk(int pcX, int pcY);
+    void wakeMovableParticleChunks(const WorldChunk& chunk);  // Those holding non-solid particles
+    void updateSleepStates(int startPCX, int startPCY, int endPCX, int endPCY);
+    int runSimTilePhases(int startPCX, int startPCY, int endPCX, int endPCY, int& chunksProcessed);
+    void updateOffscreenTiles(int viewTileX0, int viewTileY0, int viewTileX1, int viewTileY1,
+                              int& particlesUpdated, int& chunksProcessed);
+
+    // Heat diffusion and phase changes over a range of cells (inclusive); returns tiles swept
+    int updateHeat(int startX, int startY, int endX, int endY, int& phaseChanges);
+    void diffuseHeatTile(const HeatTile& tile, float* output) const;
+    int applyHeatTile(const HeatTile& tile, const float* output);  // Returns phase changes; caller flags render tiles
+    ParticleType phaseChange(ParticleType type, float temperature) const;
+    void initThermalProperties();
+    void initChunkTemperatures(WorldChunk& chunk);  // Start temperatures for fresh chunks
+
+    // Wetness contacts and frontier, for the whole loaded area
+    void updateWetness();
+    void findWetContacts(int pcX, int pcY);
+    bool updateWetCell(const WetCell& cell);  // False once it has converged
+    bool touchesWater(int worldX, int worldY) const;
+
+    // Particle chunks of the chunks kept loaded around the camera (inclusive)
+    void getLoadedParticleChunkRange(int& startPCX, int& startPCY, int& endPCX, int& endPCY) const;
+
+    // Ballistic particles
+    void launchParticle(int worldX, int worldY, float vx, float vy);  // Lift a cell out of the grid
+    int updateBallistics(int& lost);                                   // Returns particles landed
+    bool landBallistic(int index, int worldX, int worldY);
+    bool placeBallistic(int index, int worldX, int worldY);  // False if the cell is taken
+
+    static bool isAmbient(float temperature) {
+        return std::abs(temperature - AMBIENT_TEMPERATURE) < AMBIENT_TOLERANCE;
+    }
+    void markWarm(int worldX, int worldY) {
+        warmHeatTiles.set(worldX / HEAT_TILE_SIZE, worldY / HEAT_TILE_SIZE);
+    }
 
     // Particle physics (simplified versions that work across chunks)
     void updateSandParticle(int worldX, int worldY);
@@ -290,28 +554,50 @@ private:
     void updateFireParticle(int worldX, int worldY);
     void updateIceParticle(int worldX, int worldY);
     void updateMossParticle(int worldX, int worldY);
-    void updateWetnessForParticle(int x, int y);
 
     // Movement helpers
     bool canMoveTo(int worldX, int worldY) const;
     void moveParticle(int fromX, int fromY, int toX, int toY);
     void swapParticles(int x1, int y1, int x2, int y2);
+    void dropFallingRun(WorldChunk* chunk, int worldX, int worldY, int count);  // See WorldChunk::dropRun
     void markSettled(int worldX, int worldY, bool settled);
 
     // Color generation
-    ParticleColor generateRandomColor(int baseR, int baseG, int baseB, int variation);
+    ParticleColor generateRandomColor(int baseR, int baseG, int baseB, int variation) const;
+    ParticleColor randomParticleColor(ParticleType type) const;  // Config colour of the type, with variation
 
     // Sleep system
     static constexpr int FRAMES_UNTIL_SLEEP = 30;
     void wakeChunkAtWorldPos(int worldX, int worldY);
 
+    // Flag the render tile of a changed cell, and the tile its fire glow would reach
+    void markRenderDirty(int worldX, int worldY) {
+        int tileX = worldX / RENDER_TILE_SIZE;
+        renderDirty.set(tileX, worldY / RENDER_TILE_SIZE);
+        renderDirty.set(tileX, std::max(0, worldY - FIRE_GLOW_HEIGHT) / RENDER_TILE_SIZE);
+    }
+    void markChunkRenderDirty(int chunkX, int chunkY);
+
     // Scene image for lazy loading (stored in memory)
     unsigned char* sceneImageData = nullptr;
     int sceneImageWidth = 0;
     int sceneImageHeight = 0;
+    std::unique_ptr<ScenePalette> scenePalette;  // Built with the first scene image
+    std::unique_ptr<LevelFile> sceneLevel;       // Baked level used instead of an image
     std::unordered_map<ChunkKey, bool, ChunkKeyHash> chunksPopulatedFromScene;
 
-    void populateChunkFromScene(WorldChunk* chunk);
-    void procedurallyGenerateMoss(WorldChunk* chunk);
+    bool hasScene() const { return sceneImageData || sceneLevel; }
+    void populateChunkFromScene(WorldChunk* chunk, std::vector<EnemySpawnPoint>& spawnPoints) const;
+    void populateChunkFromLevel(WorldChunk* chunk, std::vector<EnemySpawnPoint>& spawnPoints) const;
+    void procedurallyGenerateMoss(ChunkCanvas& canvas) const;
+
+    // Insert a finished chunk into the chunk map/table and take over its spawn points
+    WorldChunk* publishChunk(std::unique_ptr<WorldChunk> chunk, bool populatedFromScene,
+                             const std::vector<EnemySpawnPoint>& spawnPoints);
+
+    // Seconds until the region around the viewport reaches a chunk at the camera's current
+    // velocity: 0 if it already overlaps, infinity if it is not approaching. receding is set
+    // when the camera is moving away from the chunk.
+    float chunkArrivalTime(int chunkX, int chunkY, bool& receding) const;
     float getMaxSaturation(ParticleType type) const;
 };
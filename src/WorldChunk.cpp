@@ -1,27 +1,26 @@
 #include "SandSimulator.h"  // For ParticleType, ParticleColor, ParticleVelocity
 #include "WorldChunk.h"
 
+static constexpr int CELLS_PER_CHUNK = WorldChunk::CHUNK_SIZE * WorldChunk::CHUNK_SIZE;
+
 WorldChunk::WorldChunk(int chunkX, int chunkY)
     : chunkX(chunkX)
     , chunkY(chunkY)
-    , particleCount(0)
     , sleeping(false)
     , active(false)
     , stableFrameCount(0)
+    , velocities(CELLS_PER_CHUNK, {0.0f, 0.0f})
+    , temperatures(CELLS_PER_CHUNK, 20.0f)  // Room temperature
+    , wetness(CELLS_PER_CHUNK, 0.0f)
+    , attachmentGroups(CELLS_PER_CHUNK, 0)
+    , ages(CELLS_PER_CHUNK, 0)
 {
-    const int SIZE = CHUNK_SIZE * CHUNK_SIZE;
+    particles.resize(CELLS_PER_CHUNK, ParticleType::EMPTY);
+    flags.resize(CELLS_PER_CHUNK, FLAG_SETTLED);
+    colors.resize(CELLS_PER_CHUNK, {0, 0, 0});
 
-    particles.resize(SIZE, ParticleType::EMPTY);
-    colors.resize(SIZE, {0, 0, 0});
-    velocities.resize(SIZE, {0.0f, 0.0f});
-    temperatures.resize(SIZE, 20.0f);  // Room temperature
-    wetness.resize(SIZE, 0.0f);
-    settledFlags.resize(SIZE, true);
-    freefallFlags.resize(SIZE, false);
-    explodingFlags.resize(SIZE, false);
-    movedFlags.resize(SIZE, false);
-    attachmentGroups.resize(SIZE, 0);
-    ages.resize(SIZE, 0);
+    for (auto& count : typeCounts) count.store(0, std::memory_order_relaxed);
+    typeCounts[(int)ParticleType::EMPTY].store(CELLS_PER_CHUNK, std::memory_order_relaxed);
 }
 
 ParticleType WorldChunk::getParticle(int localX, int localY) const {
@@ -33,14 +32,92 @@ void WorldChunk::setParticle(int localX, int localY, ParticleType type) {
     if (!inBounds(localX, localY)) return;
     int idx = getIndex(localX, localY);
 
-    // Update particle count
-    if (particles[idx] == ParticleType::EMPTY && type != ParticleType::EMPTY) {
-        particleCount++;
-    } else if (particles[idx] != ParticleType::EMPTY && type == ParticleType::EMPTY) {
-        particleCount--;
+    if (particles[idx] != type) {
+        countTypeChange(particles[idx], type);
+        particles[idx] = type;
+    }
+}
+
+void WorldChunk::moveParticle(int fromX, int fromY, int toX, int toY) {
+    if (!inBounds(fromX, fromY) || !inBounds(toX, toY)) return;
+    int fromIdx = getIndex(fromX, fromY);
+    int toIdx = getIndex(toX, toY);
+    if (fromIdx == toIdx) return;
+
+    // Only the overwritten destination particle leaves the histogram
+    ParticleType overwritten = particles[toIdx];
+    if (overwritten != ParticleType::EMPTY) countTypeChange(overwritten, ParticleType::EMPTY);
+
+    particles[toIdx] = particles[fromIdx];
+    particles[fromIdx] = ParticleType::EMPTY;
+}
+
+void WorldChunk::swapParticles(int x1, int y1, int x2, int y2) {
+    if (!inBounds(x1, y1) || !inBounds(x2, y2)) return;
+    std::swap(particles[getIndex(x1, y1)], particles[getIndex(x2, y2)]);
+}
+
+int WorldChunk::countFallingRun(int localX, int localY, int maxCount, bool parity) const {
+    if (!inBounds(localX, localY) || localY + 1 >= CHUNK_SIZE) return 0;
+    int idx = getIndex(localX, localY);
+    int count = std::min(maxCount, CHUNK_SIZE - localX);
+    unsigned char parityBit = parity ? FLAG_UPDATE_PARITY : 0;
+
+    int run = 0;
+    while (run < count) {
+        ParticleType type = particles[idx + run];
+        if (type != ParticleType::SAND && type != ParticleType::WATER) break;
+        if ((flags[idx + run] & FLAG_UPDATE_PARITY) == parityBit) break;
+        if (particles[idx + run + CHUNK_SIZE] != ParticleType::EMPTY) break;
+        run++;
+    }
+    return run;
+}
+
+void WorldChunk::dropRun(int localX, int localY, int count, bool parity) {
+    int from = getIndex(localX, localY);
+    int to = from + CHUNK_SIZE;
+
+    // The cells below are empty, so the type histogram does not change
+    std::copy_n(&particles[from], count, &particles[to]);
+    std::fill_n(&particles[from], count, ParticleType::EMPTY);
+    std::copy_n(&colors[from], count, &colors[to]);
+    std::fill_n(&colors[from], count, ParticleColor{0, 0, 0});
+
+    // Both rows are stamped as updated; the moved particles are no longer settled
+    unsigned char parityBit = parity ? FLAG_UPDATE_PARITY : 0;
+    for (int i = 0; i < count; ++i) {
+        flags[from + i] = (flags[from + i] & ~FLAG_UPDATE_PARITY) | parityBit;
+        flags[to + i] = (flags[to + i] & ~(FLAG_UPDATE_PARITY | FLAG_SETTLED)) | parityBit;
+    }
+
+    // Cold planes only if allocated (unallocated rows read as defaults on both sides).
+    // Like moveParticle, the velocity is cleared behind the particle and the temperature is not.
+    if (velocities.isAllocated()) {
+        ParticleVelocity* values = velocities.values();
+        std::copy_n(values + from, count, values + to);
+        std::fill_n(values + from, count, ParticleVelocity{0.0f, 0.0f});
     }
+    if (temperatures.isAllocated()) {
+        float* values = temperatures.values();
+        std::copy_n(values + from, count, values + to);
+    }
+}
+
+void WorldChunk::attachTypeTotals(std::atomic<int>* totals) {
+    detachTypeTotals();
+    typeTotals = totals;
+    for (int i = 0; i < PARTICLE_TYPE_COUNT; ++i) {
+        typeTotals[i].fetch_add(typeCounts[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
 
-    particles[idx] = type;
+void WorldChunk::detachTypeTotals() {
+    if (!typeTotals) return;
+    for (int i = 0; i < PARTICLE_TYPE_COUNT; ++i) {
+        typeTotals[i].fetch_sub(typeCounts[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    typeTotals = nullptr;
 }
 
 ParticleColor WorldChunk::getColor(int localX, int localY) const {
@@ -53,96 +130,304 @@ void WorldChunk::setColor(int localX, int localY, ParticleColor color) {
     colors[getIndex(localX, localY)] = color;
 }
 
+void WorldChunk::toARGB(const ParticleType* cellTypes, const ParticleColor* cellColors, int count, uint32_t* out) {
+    for (int i = 0; i < count; ++i) {
+        uint32_t argb = 0xFF000000u | ((uint32_t)cellColors[i].r << 16) | ((uint32_t)cellColors[i].g << 8) | cellColors[i].b;
+        uint32_t mask = cellTypes[i] != ParticleType::EMPTY ? 0xFFFFFFFFu : 0u;
+        out[i] = argb & mask;
+    }
+}
+
 ParticleVelocity WorldChunk::getVelocity(int localX, int localY) const {
     if (!inBounds(localX, localY)) return {0.0f, 0.0f};
-    return velocities[getIndex(localX, localY)];
+    return velocities.get(getIndex(localX, localY));
 }
 
 void WorldChunk::setVelocity(int localX, int localY, ParticleVelocity vel) {
     if (!inBounds(localX, localY)) return;
-    velocities[getIndex(localX, localY)] = vel;
+    velocities.set(getIndex(localX, localY), vel);
 }
 
 float WorldChunk::getTemperature(int localX, int localY) const {
     if (!inBounds(localX, localY)) return 20.0f;
-    return temperatures[getIndex(localX, localY)];
+    return temperatures.get(getIndex(localX, localY));
 }
 
 void WorldChunk::setTemperature(int localX, int localY, float temp) {
     if (!inBounds(localX, localY)) return;
-    temperatures[getIndex(localX, localY)] = temp;
+    temperatures.set(getIndex(localX, localY), temp);
 }
 
 float WorldChunk::getWetness(int localX, int localY) const {
     if (!inBounds(localX, localY)) return 0.0f;
-    return wetness[getIndex(localX, localY)];
+    return wetness.get(getIndex(localX, localY));
 }
 
 void WorldChunk::setWetness(int localX, int localY, float wet) {
     if (!inBounds(localX, localY)) return;
-    wetness[getIndex(localX, localY)] = wet;
+    wetness.set(getIndex(localX, localY), wet);
 }
 
 bool WorldChunk::isSettled(int localX, int localY) const {
     if (!inBounds(localX, localY)) return true;
-    return settledFlags[getIndex(localX, localY)];
+    return getFlag(getIndex(localX, localY), FLAG_SETTLED);
 }
 
 void WorldChunk::setSettled(int localX, int localY, bool settled) {
     if (!inBounds(localX, localY)) return;
-    settledFlags[getIndex(localX, localY)] = settled;
+    setFlag(getIndex(localX, localY), FLAG_SETTLED, settled);
 }
 
 bool WorldChunk::isFreefalling(int localX, int localY) const {
     if (!inBounds(localX, localY)) return false;
-    return freefallFlags[getIndex(localX, localY)];
+    return getFlag(getIndex(localX, localY), FLAG_FREEFALL);
 }
 
 void WorldChunk::setFreefalling(int localX, int localY, bool freefall) {
     if (!inBounds(localX, localY)) return;
-    freefallFlags[getIndex(localX, localY)] = freefall;
+    setFlag(getIndex(localX, localY), FLAG_FREEFALL, freefall);
 }
 
 bool WorldChunk::isExploding(int localX, int localY) const {
     if (!inBounds(localX, localY)) return false;
-    return explodingFlags[getIndex(localX, localY)];
+    return getFlag(getIndex(localX, localY), FLAG_EXPLODING);
 }
 
 void WorldChunk::setExploding(int localX, int localY, bool exploding) {
     if (!inBounds(localX, localY)) return;
-    explodingFlags[getIndex(localX, localY)] = exploding;
+    setFlag(getIndex(localX, localY), FLAG_EXPLODING, exploding);
 }
 
-bool WorldChunk::hasMovedThisFrame(int localX, int localY) const {
+bool WorldChunk::isOnWetFrontier(int localX, int localY) const {
     if (!inBounds(localX, localY)) return false;
-    return movedFlags[getIndex(localX, localY)];
+    return getFlag(getIndex(localX, localY), FLAG_WET_FRONTIER);
 }
 
-void WorldChunk::setMovedThisFrame(int localX, int localY, bool moved) {
+void WorldChunk::setOnWetFrontier(int localX, int localY, bool onFrontier) {
     if (!inBounds(localX, localY)) return;
-    movedFlags[getIndex(localX, localY)] = moved;
+    setFlag(getIndex(localX, localY), FLAG_WET_FRONTIER, onFrontier);
+}
+
+bool WorldChunk::getUpdateParity(int localX, int localY) const {
+    if (!inBounds(localX, localY)) return false;
+    return getFlag(getIndex(localX, localY), FLAG_UPDATE_PARITY);
+}
+
+void WorldChunk::setUpdateParity(int localX, int localY, bool parity) {
+    if (!inBounds(localX, localY)) return;
+    setFlag(getIndex(localX, localY), FLAG_UPDATE_PARITY, parity);
+}
+
+void WorldChunk::fillUpdateParity(int x0, int y0, int x1, int y1, bool parity) {
+    unsigned char parityBit = parity ? FLAG_UPDATE_PARITY : 0;
+    for (int y = std::max(y0, 0); y < std::min(y1, CHUNK_SIZE); ++y) {
+        for (int x = std::max(x0, 0); x < std::min(x1, CHUNK_SIZE); ++x) {
+            int idx = getIndex(x, y);
+            flags[idx] = (flags[idx] & ~FLAG_UPDATE_PARITY) | parityBit;
+        }
+    }
 }
 
 int WorldChunk::getAttachmentGroup(int localX, int localY) const {
     if (!inBounds(localX, localY)) return 0;
-    return attachmentGroups[getIndex(localX, localY)];
+    return attachmentGroups.get(getIndex(localX, localY));
 }
 
 void WorldChunk::setAttachmentGroup(int localX, int localY, int group) {
     if (!inBounds(localX, localY)) return;
-    attachmentGroups[getIndex(localX, localY)] = group;
+    attachmentGroups.set(getIndex(localX, localY), group);
 }
 
 int WorldChunk::getParticleAge(int localX, int localY) const {
     if (!inBounds(localX, localY)) return 0;
-    return ages[getIndex(localX, localY)];
+    return ages.get(getIndex(localX, localY));
 }
 
 void WorldChunk::setParticleAge(int localX, int localY, int age) {
     if (!inBounds(localX, localY)) return;
-    ages[getIndex(localX, localY)] = age;
+    ages.set(getIndex(localX, localY), age);
+}
+
+size_t WorldChunk::getMemoryUsage() const {
+    size_t bytes = particles.size() * sizeof(ParticleType)
+                 + flags.size() * sizeof(unsigned char)
+                 + colors.size() * sizeof(ParticleColor);
+    bytes += velocities.memoryUsage();
+    bytes += temperatures.memoryUsage();
+    bytes += wetness.memoryUsage();
+    bytes += attachmentGroups.memoryUsage();
+    bytes += ages.memoryUsage();
+    return bytes;
+}
+
+// Serialized chunk layout (native byte order, the store is a per-session cache):
+//   uint32 magic, int32 chunkX, int32 chunkY, uint32 coldPlaneMask, uint32 runCount
+//   runCount x { uint8 type, uint16 length }          type plane, row-major
+//   nonEmpty x ParticleColor                            colours of non-empty cells
+//   nonEmpty x uint8                                    flags of non-empty cells
+//   run-length encoded plane for each bit set in coldPlaneMask
+static constexpr uint32_t CHUNK_MAGIC = 0x314b4357;  // "WCK1"
+
+enum ColdPlaneBits : uint32_t {
+    COLD_VELOCITY = 1 << 0,
+    COLD_TEMPERATURE = 1 << 1,
+    COLD_WETNESS = 1 << 2,
+    COLD_ATTACHMENT = 1 << 3,
+    COLD_AGE = 1 << 4
+};
+
+template <typename T>
+static void writeValue(std::vector<unsigned char>& out, const T& value) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+// Cold planes are mostly the default value, so they are stored as { uint32 runCount,
+// runCount x { uint16 length, T value } } runs
+template <typename T>
+static void writePlane(std::vector<unsigned char>& out, const LazyPlane<T>& plane) {
+    const T* values = plane.rawValues();
+    size_t runCountPos = out.size();
+    writeValue(out, (uint32_t)0);
+
+    uint32_t runCount = 0;
+    int i = 0;
+    while (i < plane.getSize()) {
+        int runEnd = i + 1;
+        while (runEnd < plane.getSize() && runEnd - i < 65535 && std::memcmp(&values[runEnd], &values[i], sizeof(T)) == 0) {
+            runEnd++;
+        }
+        writeValue(out, (uint16_t)(runEnd - i));
+        writeValue(out, values[i]);
+        runCount++;
+        i = runEnd;
+    }
+    std::memcpy(out.data() + runCountPos, &runCount, sizeof(runCount));
+}
+
+// Bounds-checked reader over a serialized chunk
+struct ChunkReader {
+    const unsigned char* data;
+    size_t size;
+    size_t pos;
+
+    template <typename T>
+    bool read(T& value) {
+        if (pos + sizeof(T) > size) return false;
+        std::memcpy(&value, data + pos, sizeof(T));
+        pos += sizeof(T);
+        return true;
+    }
+
+};
+
+template <typename T>
+static bool readPlane(ChunkReader& reader, LazyPlane<T>& plane) {
+    uint32_t runCount;
+    if (!reader.read(runCount)) return false;
+
+    T* values = plane.values();
+    int idx = 0;
+    for (uint32_t run = 0; run < runCount; ++run) {
+        uint16_t length;
+        T value;
+        if (!reader.read(length) || !reader.read(value)) return false;
+        if (idx + length > plane.getSize()) return false;
+        std::fill(values + idx, values + idx + length, value);
+        idx += length;
+    }
+    return idx == plane.getSize();
+}
+
+void WorldChunk::serialize(std::vector<unsigned char>& out) const {
+    uint32_t coldMask = 0;
+    if (velocities.isAllocated()) coldMask |= COLD_VELOCITY;
+    if (temperatures.isAllocated()) coldMask |= COLD_TEMPERATURE;
+    if (wetness.isAllocated()) coldMask |= COLD_WETNESS;
+    if (attachmentGroups.isAllocated()) coldMask |= COLD_ATTACHMENT;
+    if (ages.isAllocated()) coldMask |= COLD_AGE;
+
+    writeValue(out, CHUNK_MAGIC);
+    writeValue(out, (int32_t)chunkX);
+    writeValue(out, (int32_t)chunkY);
+    writeValue(out, coldMask);
+
+    // Type plane runs (length capped at 65535 so it fits in 16 bits)
+    size_t runCountPos = out.size();
+    writeValue(out, (uint32_t)0);
+    uint32_t runCount = 0;
+    int i = 0;
+    while (i < CELLS_PER_CHUNK) {
+        ParticleType type = particles[i];
+        int runEnd = i + 1;
+        while (runEnd < CELLS_PER_CHUNK && runEnd - i < 65535 && particles[runEnd] == type) {
+            runEnd++;
+        }
+        writeValue(out, (uint8_t)type);
+        writeValue(out, (uint16_t)(runEnd - i));
+        runCount++;
+        i = runEnd;
+    }
+    std::memcpy(out.data() + runCountPos, &runCount, sizeof(runCount));
+
+    for (int idx = 0; idx < CELLS_PER_CHUNK; ++idx) {
+        if (particles[idx] != ParticleType::EMPTY) writeValue(out, colors[idx]);
+    }
+    for (int idx = 0; idx < CELLS_PER_CHUNK; ++idx) {
+        // The frontier is World's and is rebuilt from contacts, so its flag is not kept
+        if (particles[idx] != ParticleType::EMPTY) out.push_back(flags[idx] & ~FLAG_WET_FRONTIER);
+    }
+
+    if (coldMask & COLD_VELOCITY) writePlane(out, velocities);
+    if (coldMask & COLD_TEMPERATURE) writePlane(out, temperatures);
+    if (coldMask & COLD_WETNESS) writePlane(out, wetness);
+    if (coldMask & COLD_ATTACHMENT) writePlane(out, attachmentGroups);
+    if (coldMask & COLD_AGE) writePlane(out, ages);
 }
 
-void WorldChunk::clearMovedFlags() {
-    std::fill(movedFlags.begin(), movedFlags.end(), false);
+std::unique_ptr<WorldChunk> WorldChunk::deserialize(const unsigned char* data, size_t size) {
+    ChunkReader reader{data, size, 0};
+
+    uint32_t magic, coldMask, runCount;
+    int32_t cx, cy;
+    if (!reader.read(magic) || magic != CHUNK_MAGIC) return nullptr;
+    if (!reader.read(cx) || !reader.read(cy) || !reader.read(coldMask) || !reader.read(runCount)) return nullptr;
+
+    auto chunk = std::make_unique<WorldChunk>(cx, cy);
+
+    int idx = 0;
+    int typeCounts[PARTICLE_TYPE_COUNT] = {};
+    for (uint32_t run = 0; run < runCount; ++run) {
+        uint8_t type;
+        uint16_t length;
+        if (!reader.read(type) || !reader.read(length)) return nullptr;
+        if (idx + length > CELLS_PER_CHUNK || type >= PARTICLE_TYPE_COUNT) return nullptr;
+
+        std::fill(chunk->particles.begin() + idx, chunk->particles.begin() + idx + length, (ParticleType)type);
+        typeCounts[type] += length;
+        idx += length;
+    }
+    if (idx != CELLS_PER_CHUNK) return nullptr;
+
+    for (int i = 0; i < CELLS_PER_CHUNK; ++i) {
+        if (chunk->particles[i] != ParticleType::EMPTY && !reader.read(chunk->colors[i])) return nullptr;
+    }
+    for (int i = 0; i < CELLS_PER_CHUNK; ++i) {
+        if (chunk->particles[i] != ParticleType::EMPTY && !reader.read(chunk->flags[i])) return nullptr;
+    }
+
+    if ((coldMask & COLD_VELOCITY) && !readPlane(reader, chunk->velocities)) return nullptr;
+    if ((coldMask & COLD_TEMPERATURE) && !readPlane(reader, chunk->temperatures)) return nullptr;
+    if ((coldMask & COLD_WETNESS) && !readPlane(reader, chunk->wetness)) return nullptr;
+    if ((coldMask & COLD_ATTACHMENT) && !readPlane(reader, chunk->attachmentGroups)) return nullptr;
+    if ((coldMask & COLD_AGE) && !readPlane(reader, chunk->ages)) return nullptr;
+
+    for (int i = 0; i < PARTICLE_TYPE_COUNT; ++i) {
+        chunk->typeCounts[i].store(typeCounts[i], std::memory_order_relaxed);
+    }
+    if (!chunk->isEmpty()) {
+        chunk->setActive(true);
+        chunk->setSleeping(false);
+    }
+    return chunk;
 }
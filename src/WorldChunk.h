@@ -1,19 +1,82 @@
 #pragma once
 #include "Config.h"
+#include "SandSimulator.h"  // For ParticleType, ParticleColor, ParticleVelocity
 #include <vector>
 #include <cstdint>
 #include <memory>
+#include <atomic>
+#include <cstring>
+#include <algorithm>
+
+// Per-cell plane that is only allocated once a cell gets a non-default value.
+// Reads from an unallocated plane return the default. Allocation is a compare-exchange,
+// so two simulation threads writing into the same fresh plane agree on one buffer.
+template <typename T>
+class LazyPlane {
+public:
+    LazyPlane(int size, T defaultValue) : size(size), defaultValue(defaultValue), data(nullptr) {}
+    ~LazyPlane() { delete[] data.load(std::memory_order_relaxed); }
+
+    LazyPlane(const LazyPlane&) = delete;
+    LazyPlane& operator=(const LazyPlane&) = delete;
+
+    T get(int idx) const {
+        const T* values = data.load(std::memory_order_acquire);
+        return values ? values[idx] : defaultValue;
+    }
+
+    void set(int idx, T value) {
+        T* values = data.load(std::memory_order_acquire);
+        if (!values) {
+            if (std::memcmp(&value, &defaultValue, sizeof(T)) == 0) return;  // Nothing to store
+            values = allocate();
+        }
+        values[idx] = value;
+    }
 
-// Forward declarations - actual definitions are in SandSimulator.h
-enum class ParticleType : unsigned char;
-struct ParticleColor;
-struct ParticleVelocity;
+    bool isAllocated() const { return data.load(std::memory_order_relaxed) != nullptr; }
+    int getSize() const { return size; }
+    size_t memoryUsage() const { return isAllocated() ? size * sizeof(T) : 0; }
+
+    // Raw values, or nullptr if the plane has not been allocated
+    const T* rawValues() const { return data.load(std::memory_order_acquire); }
+
+    // Raw values, allocating the plane if needed (for bulk passes over the whole chunk)
+    T* values() {
+        T* values = data.load(std::memory_order_acquire);
+        return values ? values : allocate();
+    }
+
+private:
+    int size;
+    T defaultValue;
+    std::atomic<T*> data;
+
+    T* allocate() {
+        T* fresh = new T[size];
+        std::fill(fresh, fresh + size, defaultValue);
+
+        T* expected = nullptr;
+        if (!data.compare_exchange_strong(expected, fresh, std::memory_order_acq_rel)) {
+            delete[] fresh;  // Another thread allocated first
+            return expected;
+        }
+        return fresh;
+    }
+};
 
 // A 512x512 chunk of the world
 class WorldChunk {
 public:
     static constexpr int CHUNK_SIZE = 512;
 
+    // Bits of the per-cell flag byte
+    static constexpr unsigned char FLAG_SETTLED = 1 << 0;
+    static constexpr unsigned char FLAG_FREEFALL = 1 << 1;
+    static constexpr unsigned char FLAG_EXPLODING = 1 << 2;
+    static constexpr unsigned char FLAG_UPDATE_PARITY = 1 << 3;  // See getUpdateParity()
+    static constexpr unsigned char FLAG_WET_FRONTIER = 1 << 4;   // On World's wetness frontier (not saved)
+
     WorldChunk(int chunkX, int chunkY);
     ~WorldChunk() = default;
 
@@ -29,15 +92,36 @@ public:
     ParticleType getParticle(int localX, int localY) const;
     void setParticle(int localX, int localY, ParticleType type);
 
+    // Type-plane moves inside this chunk. The type histogram only changes when moveParticle
+    // overwrites a non-empty cell, so the common falling/flowing moves touch no counters.
+    void moveParticle(int fromX, int fromY, int toX, int toY);  // Leaves EMPTY behind
+    void swapParticles(int x1, int y1, int x2, int y2);
+
+    // Fast path for bulk falls. countFallingRun gives how many cells from localX rightwards
+    // (at most maxCount, never past the chunk) hold sand or water not yet stamped with parity
+    // and have an empty cell below. dropRun moves such a run down one row, leaving the cells
+    // exactly as one moveParticle per cell would, but a plane at a time.
+    int countFallingRun(int localX, int localY, int maxCount, bool parity) const;
+    void dropRun(int localX, int localY, int count, bool parity);
+
     ParticleColor getColor(int localX, int localY) const;
     void setColor(int localX, int localY, ParticleColor color);
 
+    // Write count cells as ARGB8888 (opaque colour, or 0 for empty cells).
+    // Branch-free so the compiler vectorises it.
+    static void toARGB(const ParticleType* cellTypes, const ParticleColor* cellColors, int count, uint32_t* out);
+
     ParticleVelocity getVelocity(int localX, int localY) const;
     void setVelocity(int localX, int localY, ParticleVelocity vel);
 
     float getTemperature(int localX, int localY) const;
     void setTemperature(int localX, int localY, float temp);
 
+    // Whole temperature plane for bulk passes: nullptr while every cell is at the default,
+    // or allocated on request
+    const float* getTemperatureValues() const { return temperatures.rawValues(); }
+    float* allocateTemperatureValues() { return temperatures.values(); }
+
     float getWetness(int localX, int localY) const;
     void setWetness(int localX, int localY, float wet);
 
@@ -50,8 +134,14 @@ public:
     bool isExploding(int localX, int localY) const;
     void setExploding(int localX, int localY, bool exploding);
 
-    bool hasMovedThisFrame(int localX, int localY) const;
-    void setMovedThisFrame(int localX, int localY, bool moved);
+    bool isOnWetFrontier(int localX, int localY) const;
+    void setOnWetFrontier(int localX, int localY, bool onFrontier);
+
+    // Parity of the last world frame that updated this cell or moved a particle into it.
+    // Compared against the world's frame parity, so it never needs clearing between frames.
+    bool getUpdateParity(int localX, int localY) const;
+    void setUpdateParity(int localX, int localY, bool parity);
+    void fillUpdateParity(int x0, int y0, int x1, int y1, bool parity);  // Cells x0..x1-1, y0..y1-1
 
     int getAttachmentGroup(int localX, int localY) const;
     void setAttachmentGroup(int localX, int localY, int group);
@@ -60,59 +150,81 @@ public:
     void setParticleAge(int localX, int localY, int age);
 
     // Bulk operations
-    void clearMovedFlags();
-    bool isEmpty() const { return particleCount == 0; }
-    int getParticleCount() const { return particleCount; }
-
-    // Sleep state
-    bool isSleeping() const { return sleeping; }
-    void setSleeping(bool sleep) { sleeping = sleep; }
-    bool isActive() const { return active; }
-    void setActive(bool act) { active = act; }
-    int getStableFrameCount() const { return stableFrameCount; }
-    void incrementStableFrames() { stableFrameCount++; }
-    void resetStableFrames() { stableFrameCount = 0; }
+    bool isEmpty() const { return getParticleCount() == 0; }
+
+    // Bytes currently allocated for cell data (hot planes + allocated cold planes)
+    size_t getMemoryUsage() const;
+
+    // Compact binary form used by the region store: run-length encoded type plane,
+    // colours and flags of non-empty cells, then any allocated cold planes
+    void serialize(std::vector<unsigned char>& out) const;
+    static std::unique_ptr<WorldChunk> deserialize(const unsigned char* data, size_t size);
+    int getParticleCount() const { return CHUNK_SIZE * CHUNK_SIZE - getTypeCount(ParticleType::EMPTY); }
+    int getTypeCount(ParticleType type) const { return typeCounts[(int)type].load(std::memory_order_relaxed); }
+
+    // World-wide per-type totals this chunk reports its histogram changes to while loaded.
+    // Attaching adds the chunk's current histogram, detaching removes it.
+    void attachTypeTotals(std::atomic<int>* totals);
+    void detachTypeTotals();
+
+    // Sleep state (atomic: tiles of the same chunk are simulated on several threads)
+    bool isSleeping() const { return sleeping.load(std::memory_order_relaxed); }
+    void setSleeping(bool sleep) { sleeping.store(sleep, std::memory_order_relaxed); }
+    bool isActive() const { return active.load(std::memory_order_relaxed); }
+    void setActive(bool act) { active.store(act, std::memory_order_relaxed); }
+    int getStableFrameCount() const { return stableFrameCount.load(std::memory_order_relaxed); }
+    void incrementStableFrames() { stableFrameCount.fetch_add(1, std::memory_order_relaxed); }
+    void resetStableFrames() { stableFrameCount.store(0, std::memory_order_relaxed); }
 
     // Check if coordinates are valid
     static bool inBounds(int localX, int localY) {
         return localX >= 0 && localX < CHUNK_SIZE && localY >= 0 && localY < CHUNK_SIZE;
     }
 
-    // Direct array access for fast simulation
+    // Direct array access for fast simulation (hot planes only)
     std::vector<ParticleType>& getParticleGrid() { return particles; }
     std::vector<ParticleColor>& getColorGrid() { return colors; }
-    std::vector<ParticleVelocity>& getVelocityGrid() { return velocities; }
-    std::vector<float>& getTemperatureGrid() { return temperatures; }
-    std::vector<float>& getWetnessGrid() { return wetness; }
-    std::vector<bool>& getSettledGrid() { return settledFlags; }
-    std::vector<bool>& getFreefallGrid() { return freefallFlags; }
-    std::vector<bool>& getExplodingGrid() { return explodingFlags; }
-    std::vector<bool>& getMovedGrid() { return movedFlags; }
-    std::vector<int>& getAttachmentGrid() { return attachmentGroups; }
-    std::vector<int>& getAgeGrid() { return ages; }
+    std::vector<unsigned char>& getFlagGrid() { return flags; }
 
     const std::vector<ParticleType>& getParticleGrid() const { return particles; }
     const std::vector<ParticleColor>& getColorGrid() const { return colors; }
+    const std::vector<unsigned char>& getFlagGrid() const { return flags; }
 
 private:
     int chunkX, chunkY;  // Chunk position in chunk coordinates
-    int particleCount;
-    bool sleeping;
-    bool active;
-    int stableFrameCount;
-
-    // Particle data arrays (CHUNK_SIZE * CHUNK_SIZE elements each)
+    std::atomic<int> typeCounts[PARTICLE_TYPE_COUNT];  // Cells of each type, updated by setParticle
+    std::atomic<int>* typeTotals = nullptr;
+    std::atomic<bool> sleeping;
+    std::atomic<bool> active;
+    std::atomic<int> stableFrameCount;
+
+    // Hot planes (CHUNK_SIZE * CHUNK_SIZE elements each), touched by every cell update.
+    // Flags are one byte per cell (FLAG_* bits) so threads never share a flag word.
     std::vector<ParticleType> particles;
+    std::vector<unsigned char> flags;
     std::vector<ParticleColor> colors;
-    std::vector<ParticleVelocity> velocities;
-    std::vector<float> temperatures;
-    std::vector<float> wetness;
-    std::vector<bool> settledFlags;
-    std::vector<bool> freefallFlags;
-    std::vector<bool> explodingFlags;
-    std::vector<bool> movedFlags;
-    std::vector<int> attachmentGroups;
-    std::vector<int> ages;
+
+    // Cold planes, allocated only once a cell in this chunk leaves the default value
+    LazyPlane<ParticleVelocity> velocities;
+    LazyPlane<float> temperatures;
+    LazyPlane<float> wetness;
+    LazyPlane<int> attachmentGroups;
+    LazyPlane<int> ages;
+
+    bool getFlag(int idx, unsigned char flag) const { return (flags[idx] & flag) != 0; }
+    void setFlag(int idx, unsigned char flag, bool value) {
+        if (value) flags[idx] |= flag;
+        else flags[idx] &= ~flag;
+    }
+
+    void countTypeChange(ParticleType from, ParticleType to) {
+        typeCounts[(int)from].fetch_sub(1, std::memory_order_relaxed);
+        typeCounts[(int)to].fetch_add(1, std::memory_order_relaxed);
+        if (typeTotals) {
+            typeTotals[(int)from].fetch_sub(1, std::memory_order_relaxed);
+            typeTotals[(int)to].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
 
     int getIndex(int localX, int localY) const {
         return localY * CHUNK_SIZE + localX;
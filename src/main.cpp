@@ -5,9 +5,14 @@
 #include <string>
 #include <cmath>
 #include <vector>
+#include <deque>
 #include <algorithm>
+#include <cstdio>
+#include <filesystem>
 #include "Config.h"
 #include "World.h"
+#include "SimulationLoop.h"
+#include "Profiler.h"
 #include "SandSimulator.h"
 #include "Sprite.h"
 #include "SceneObject.h"
@@ -17,6 +22,7 @@
 #include "ZLayers.h"
 #include "MainSprite.h"
 #include "LittlePurpleJumper.h"
+#include "EnemyGrid.h"
 #include "BouncingBolt.h"
 #include "SparkBolt.h"
 #include "FireBolt.h"
@@ -305,9 +311,24 @@ int main(int argc, char* argv[]) {
 
     // Vector to hold enemies
     std::vector<LittlePurpleJumper> purpleJumpers;
-
-    // Set scene image - will lazy load chunks as they come into view
-    world.setSceneImage("scenes/level1.png");
+    EnemyGrid enemyGrid;  // Rebuilt each frame for bullet hit tests and homing
+
+    // Set scene - will lazy load chunks as they come into view. A baked level (level_bake)
+    // is mapped instead of decoding the image when one is present, unless the image has been
+    // edited since it was baked.
+    bool useBakedLevel = std::filesystem::exists("scenes/level1.lvl");
+    if (useBakedLevel) {
+        std::error_code levelTimeError, imageTimeError;
+        auto levelTime = std::filesystem::last_write_time("scenes/level1.lvl", levelTimeError);
+        auto imageTime = std::filesystem::last_write_time("scenes/level1.png", imageTimeError);
+        if (!levelTimeError && !imageTimeError && imageTime > levelTime) {
+            std::cerr << "scenes/level1.lvl is older than scenes/level1.png, loading the image (re-run level_bake)" << std::endl;
+            useBakedLevel = false;
+        }
+    }
+    if (!useBakedLevel || !world.setSceneLevel("scenes/level1.lvl")) {
+        world.setSceneImage("scenes/level1.png");
+    }
 
     // Create player sprite
     auto playerSprite = std::make_shared<Sprite>();
@@ -389,14 +410,27 @@ int main(int argc, char* argv[]) {
     // Camera will smoothly follow player with deadzone
     // This keeps the player centered even at world edges
 
+    // Particles are simulated at a fixed rate (on their own thread unless configured
+    // otherwise); the frame loop draws the newest snapshot of the region around the camera
+    SimulationLoop simulation(world, viewportWidth, viewportHeight);
+    const int snapshotMargin = SimulationLoop::SNAPSHOT_MARGIN;
+
     SDL_Texture* viewportTexture = SDL_CreateTexture(
         renderer,
         SDL_PIXELFORMAT_ARGB8888,  // Match Uint32 pixel format
         SDL_TEXTUREACCESS_STREAMING,
+        simulation.getSnapshotWidth(),
+        simulation.getSnapshotHeight()
+    );
+    // Bullets are drawn every frame on top of the (less frequently updated) world snapshot
+    SDL_Texture* bulletTexture = SDL_CreateTexture(
+        renderer,
+        SDL_PIXELFORMAT_ARGB8888,
+        SDL_TEXTUREACCESS_STREAMING,
         viewportWidth,
         viewportHeight
     );
-    if (!viewportTexture) {
+    if (!viewportTexture || !bulletTexture) {
         std::cerr << "Viewport texture creation failed: " << SDL_GetError() << "\n";
         TTF_CloseFont(smallFont);
         TTF_CloseFont(font);
@@ -408,8 +442,10 @@ int main(int argc, char* argv[]) {
     }
     // Enable alpha blending so ZLayers show through transparent pixels
     SDL_SetTextureBlendMode(viewportTexture, SDL_BLENDMODE_BLEND);
+    SDL_SetTextureBlendMode(bulletTexture, SDL_BLENDMODE_BLEND);
 
-    std::vector<Uint32> pixels(viewportWidth * viewportHeight);
+    std::vector<Uint32> bulletPixels(viewportWidth * viewportHeight, 0);
+    uint64_t uploadedSnapshot = 0;
 
     // Setup material dropdown
     UIDropdown dropdown;
@@ -449,6 +485,9 @@ int main(int argc, char* argv[]) {
     CachedText posCache;
     CachedText sandCountCache, waterCountCache, rockCountCache, lavaCountCache;
     CachedText steamCountCache, fireCountCache, obsidianCountCache, iceCountCache, glassCountCache;
+    std::deque<CachedText> profilerCache;  // deque: CachedText owns its texture and is not copyable
+    std::vector<std::string> profilerLines;
+    Uint32 profilerTextTime = 0;
 
     int targetFPS = fpsValues[fpsDropdown.selectedIndex];
     int frameDelay = 1000 / targetFPS;
@@ -462,6 +501,7 @@ int main(int argc, char* argv[]) {
     bool thrustHeld = false;  // Spacebar for jetpack thrust
     bool eKeyPressed = false;  // For collectible interaction
     bool inventoryOpen = false;  // Toggle with 'I' key
+    bool profilerOverlay = false;  // Toggle with F3 (F4 writes the profile to disk)
 
     // Inventory items (true = collected)
     bool hasBulletDoubler = false;
@@ -476,11 +516,23 @@ int main(int argc, char* argv[]) {
     const float AIR_FRICTION = 0.95f;    // Horizontal slowdown in air
     const float GROUND_FRICTION = 0.9f;  // Horizontal slowdown on ground
 
+    if (config.simulationThread) {
+        simulation.start();
+    }
+
     while (running) {
         Uint32 frameStart = SDL_GetTicks();
         float deltaTime = (frameStart - lastFrameTime) / 1000.0f;
         lastFrameTime = frameStart;
 
+        // The simulation steps between the sections below that hold the world, so each one
+        // holds it only for the calls that read or change the world
+        std::unique_lock<std::mutex> worldLock;
+        auto lockWorld = [&]() {
+            PROFILE_SCOPE("world lock wait");
+            worldLock = simulation.lockWorld();
+        };
+
         SDL_Event event;
         while (SDL_PollEvent(&event)) {
             if (event.type == SDL_QUIT) {
@@ -519,6 +571,17 @@ int main(int argc, char* argv[]) {
                     case SDLK_i:
                         inventoryOpen = !inventoryOpen;
                         break;
+#ifdef SAND_PROFILING
+                    case SDLK_F3:
+                        profilerOverlay = !profilerOverlay;
+                        break;
+                    case SDLK_F4:
+                        if (Profiler::instance().writeCsv("profile.csv") &&
+                            Profiler::instance().writeChromeTrace("profile_trace.json")) {
+                            std::cout << "Wrote profile.csv and profile_trace.json" << std::endl;
+                        }
+                        break;
+#endif
                 }
             }
             else if (event.type == SDL_KEYUP) {
@@ -571,6 +634,8 @@ int main(int argc, char* argv[]) {
 
                         // ==================== Player Physics ====================
 
+                        lockWorld();  // Collisions, the player's scene object and the camera
+
                         const auto& cap = player->getCapsule();
 
                         float collisionY;
@@ -730,6 +795,10 @@ int main(int argc, char* argv[]) {
                    camDirX, camDirY,  // movement direction for look-ahead
                    (float)World::WORLD_WIDTH, (float)World::WORLD_HEIGHT, deltaTime);
 
+        // Publish chunks generated in the background and queue the rest of the load ring
+        world.loadChunksAroundCamera();
+        worldLock.unlock();
+
         // Update and check collectibles
         float playerW = (float)playerSprite->getWidth();
         float playerH = (float)playerSprite->getHeight();
@@ -781,6 +850,7 @@ int main(int argc, char* argv[]) {
         }
 
         // Spawn enemies from detected spawn points
+        lockWorld();  // Spawn points and enemy collisions
         for (auto& spawnPoint : world.getEnemySpawnPoints()) {
             if (!spawnPoint.spawned && spawnPoint.type == SpawnMarkerType::LITTLE_PURPLE_JUMPER) {
                 LittlePurpleJumper jumper;
@@ -792,15 +862,28 @@ int main(int argc, char* argv[]) {
         }
 
         // Update enemies
-        float playerCenterXForEnemy = player->getX() + playerW / 2.0f;
-        float playerCenterYForEnemy = player->getY() + playerH / 2.0f;
-        for (auto& jumper : purpleJumpers) {
-            jumper.update(deltaTime, playerCenterXForEnemy, playerCenterYForEnemy);
+        {
+            PROFILE_SCOPE("enemies update");
+            float playerCenterXForEnemy = player->getX() + playerW / 2.0f;
+            float playerCenterYForEnemy = player->getY() + playerH / 2.0f;
+            for (auto& jumper : purpleJumpers) {
+                jumper.update(deltaTime, playerCenterXForEnemy, playerCenterYForEnemy);
+            }
+            worldLock.unlock();
+            enemyGrid.rebuild(purpleJumpers);
         }
 
         // Update gun ammunition (bullets)
         if (equippedGun && equippedGun->isEquipped()) {
-            equippedGun->updateAmmunition(deltaTime, world, purpleJumpers);
+            PROFILE_SCOPE("bullets update");
+            lockWorld();  // Raycasts and explosions
+            equippedGun->updateAmmunition(deltaTime, world, enemyGrid);
+            worldLock.unlock();
+        }
+
+        // Without the thread nothing else touches the world
+        if (!simulation.isThreaded()) {
+            simulation.advance(deltaTime);
         }
 
                 // Ensure OpenGL context is current
@@ -834,172 +917,33 @@ int main(int argc, char* argv[]) {
                 // Render background layers (mountains) before particles
                 zLayers.render(renderer, cam.x, cam.y, viewportWidth, viewportHeight, scaleX, scaleY);
 
-                // --- Optimized particle rendering ---
-                // Visible region is exactly viewportWidth x viewportHeight (512x512)
-                int visWorldX_start = (int)cam.x;
-                int visWorldY_start = (int)cam.y;
-                int visWorldX_end = visWorldX_start + viewportWidth;
-                int visWorldY_end = visWorldY_start + viewportHeight;
-
-        
-
-                int startChunkX, startChunkY, endChunkX, endChunkY;
-
-                World::worldToChunk(visWorldX_start, visWorldY_start, startChunkX, startChunkY);
-
-                World::worldToChunk(visWorldX_end - 1, visWorldY_end - 1, endChunkX, endChunkY);
-
-        
-
-                std::fill(pixels.begin(), pixels.end(), 0x00000000);  // Transparent so zlayers show through
-
-        
-
-                for (int cy = startChunkY; cy <= endChunkY; ++cy) {
-
-                    for (int cx = startChunkX; cx <= endChunkX; ++cx) {
-
-                        const WorldChunk* chunk = world.getChunk(cx, cy);
-
-                        if (!chunk) continue;
-
-        
-
-                        const auto& colors = chunk->getColorGrid();
-
-                        const auto& particles = chunk->getParticleGrid();
-
-                        int chunkWorldX = chunk->getWorldX();
-
-                        int chunkWorldY = chunk->getWorldY();
-
-        
-
-                        int loop_x_start = std::max(visWorldX_start, chunkWorldX);
-
-                        int loop_y_start = std::max(visWorldY_start, chunkWorldY);
-
-                        int loop_x_end = std::min(visWorldX_end, chunkWorldX + WorldChunk::CHUNK_SIZE);
-
-                        int loop_y_end = std::min(visWorldY_end, chunkWorldY + WorldChunk::CHUNK_SIZE);
-
-        
-
-                        for (int worldY = loop_y_start; worldY < loop_y_end; ++worldY) {
-
-                            int screenY = worldY - visWorldY_start;
-
-                            int localY = worldY - chunkWorldY;
-
-                            int pixel_idx_base = screenY * viewportWidth;
-
-                            int chunk_idx_base = localY * WorldChunk::CHUNK_SIZE;
-
-        
-
-                            for (int worldX = loop_x_start; worldX < loop_x_end; ++worldX) {
-
-                                int screenX = worldX - visWorldX_start;
-
-                                int localX = worldX - chunkWorldX;
-
-        
-
-                                int chunk_idx = chunk_idx_base + localX;
-
-                                if (particles[chunk_idx] != ParticleType::EMPTY) {
-
-                                    const auto& color = colors[chunk_idx];
-
-                                    pixels[pixel_idx_base + screenX] = 0xFF000000 | (color.r << 16) | (color.g << 8) | color.b;
-
-                                }
-
-                            }
-
-                        }
-
-                    }
-
+                // Particles and fire glow (transparent where empty so the z-layers show through),
+                // uploaded only when the simulation published a new snapshot. The snapshot
+                // extends past the viewport, so the camera scrolls at display rate in between.
+                const SimulationLoop::Snapshot& snapshot = simulation.acquireSnapshot();
+                if (snapshot.sequence != uploadedSnapshot) {
+                    PROFILE_SCOPE("texture upload");
+                    SDL_UpdateTexture(viewportTexture, nullptr, snapshot.pixels.data(), simulation.getSnapshotWidth() * sizeof(Uint32));
+                    uploadedSnapshot = snapshot.sequence;
                 }
 
-        
-
-        
-
-                // Render gun ammunition (bullets) to pixel buffer BEFORE updating texture
-                if (equippedGun && equippedGun->isEquipped()) {
-                    equippedGun->renderAmmunition(renderer, pixels, viewportWidth, viewportHeight, cam.x, cam.y, scaleX, scaleY);
-                }
-
-                // Update texture
-                SDL_UpdateTexture(viewportTexture, nullptr, pixels.data(), viewportWidth * sizeof(Uint32));
-
-        
-
-                // Render texture to screen with explicit scaling
                 SDL_Rect destRect = {0, 0, actualWindowW, actualWindowH};
-                SDL_RenderCopy(renderer, viewportTexture, nullptr, &destRect);
-
-        
-
-                // Draw fire effects
-
-                SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_ADD);
-
-                for (int y = 0; y < viewportHeight; ++y) {
-
-                    for (int x = 0; x < viewportWidth; ++x) {
-
-                        int worldX = (int)cam.x + x;
-
-                        int worldY = (int)cam.y + y;
-
-        
-
-                        if (world.getParticle(worldX, worldY) == ParticleType::FIRE) {
-
-                            ParticleColor fireColor = world.getColor(worldX, worldY);
-
-        
-
-                            for (int dy = -3; dy <= 0; ++dy) {
-
-                                int screenY = y + dy;
-
-                                if (screenY >= 0 && screenY < viewportHeight) {
-
-                                    float intensity = 1.0f - (float)(-dy) / 4.0f;
-
-                                    int alpha = (int)(intensity * 120);
-
-        
-
-                                    SDL_Rect flameRect = {x, screenY, 1, 1};
-
-                                    SDL_SetRenderDrawColor(renderer,
-
-                                        (int)(fireColor.r * intensity),
-
-                                        (int)(fireColor.g * intensity * 0.7f),
-
-                                        0, alpha);
-
-                                    SDL_RenderFillRect(renderer, &flameRect);
-
-                                }
-
-                            }
-
-                        }
-
-                    }
-
+                SDL_Rect srcRect = {
+                    std::clamp((int)cam.x - snapshot.left, 0, 2 * snapshotMargin),
+                    std::clamp((int)cam.y - snapshot.top, 0, 2 * snapshotMargin),
+                    viewportWidth, viewportHeight
+                };
+                SDL_RenderCopy(renderer, viewportTexture, &srcRect, &destRect);
+
+                // Render gun ammunition (bullets) into their own layer
+                if (equippedGun && equippedGun->isEquipped()) {
+                    PROFILE_SCOPE("bullets render");
+                    std::fill(bulletPixels.begin(), bulletPixels.end(), 0);
+                    equippedGun->renderAmmunition(renderer, bulletPixels, viewportWidth, viewportHeight, cam.x, cam.y, scaleX, scaleY);
+                    SDL_UpdateTexture(bulletTexture, nullptr, bulletPixels.data(), viewportWidth * sizeof(Uint32));
+                    SDL_RenderCopy(renderer, bulletTexture, nullptr, &destRect);
                 }
 
-                SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
-
-        
                 // Render scene objects (sprites)
                 for (const auto& obj : world.getSceneObjects()) {
                     if (!obj || !obj->isVisible()) continue;
@@ -1038,9 +982,12 @@ int main(int argc, char* argv[]) {
 
         
                 // Render enemies
-                for (auto& jumper : purpleJumpers) {
-                    jumper.render(renderer, cam.x, cam.y, scaleX, scaleY);
-                    jumper.renderHealthBar(renderer, cam.x, cam.y, scaleX, scaleY);
+                {
+                    PROFILE_SCOPE("enemies render");
+                    for (auto& jumper : purpleJumpers) {
+                        jumper.render(renderer, cam.x, cam.y, scaleX, scaleY);
+                        jumper.renderHealthBar(renderer, cam.x, cam.y, scaleX, scaleY);
+                    }
                 }
 
                         // Debug chunk outlines disabled
@@ -1052,12 +999,10 @@ int main(int argc, char* argv[]) {
                 int startPCX, startPCY, endPCX, endPCY;
                 World::worldToParticleChunk(p_visWorldX_start, p_visWorldY_start, startPCX, startPCY);
                 World::worldToParticleChunk(p_visWorldX_end - 1, p_visWorldY_end - 1, endPCX, endPCY);
-                const auto& particleChunks = world.getParticleChunks();
                 for (int pcY = startPCY; pcY <= endPCY; ++pcY) {
                     for (int pcX = startPCX; pcX <= endPCX; ++pcX) {
                         if(pcX < 0 || pcX >= World::P_CHUNKS_X || pcY < 0 || pcY >= World::P_CHUNKS_Y) continue;
-                        int pcIndex = pcY * World::P_CHUNKS_X + pcX;
-                        if (particleChunks[pcIndex].isAwake) {
+                        if (world.isParticleChunkAwake(pcX, pcY)) {
                             SDL_Rect rect;
                             rect.x = (int)((pcX * World::PARTICLE_CHUNK_WIDTH - cam.x) * scaleX);
                             rect.y = (int)((pcY * World::PARTICLE_CHUNK_HEIGHT - cam.y) * scaleY);
@@ -1105,6 +1050,9 @@ int main(int argc, char* argv[]) {
 
         
 
+            {
+                PROFILE_SCOPE("HUD");
+
                 // Draw mana bar (top right)
                 if (equippedGun && equippedGun->isEquipped()) {
                     int manaBarWidth = 120;
@@ -1326,6 +1274,42 @@ int main(int argc, char* argv[]) {
 
                     SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
                 }
+            }
+
+#ifdef SAND_PROFILING
+                // Profiler overlay (top left): per-frame average and worst over the history
+                if (profilerOverlay) {
+                    if (currentTime - profilerTextTime >= 250 || profilerLines.empty()) {
+                        Profiler& profiler = Profiler::instance();
+                        profilerLines.clear();
+                        char line[96];
+                        std::snprintf(line, sizeof(line), "frame  %.2f ms avg  %.2f max  sim %d/s",
+                                      profiler.averageFrameMillis(), profiler.maximumFrameMillis(), simulation.getStepsPerSecond());
+                        profilerLines.push_back(line);
+                        for (const Profiler::SectionSummary& section : profiler.summarise()) {
+                            if (section.kind == Profiler::Kind::TIMER) {
+                                std::snprintf(line, sizeof(line), "%-18s %6.2f ms  %6.2f max", section.name.c_str(), section.average, section.maximum);
+                            } else {
+                                std::snprintf(line, sizeof(line), "%-18s %9.0f  %9.0f max", section.name.c_str(), section.average, section.maximum);
+                            }
+                            profilerLines.push_back(line);
+                        }
+                        profilerTextTime = currentTime;
+                    }
+                    if (profilerCache.size() < profilerLines.size()) profilerCache.resize(profilerLines.size());
+
+                    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+                    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 180);
+                    SDL_Rect overlayBg = {5, 50, 300, (int)profilerLines.size() * 12 + 6};
+                    SDL_RenderFillRect(renderer, &overlayBg);
+                    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+
+                    SDL_Color profilerColor = {200, 255, 200, 255};
+                    for (size_t i = 0; i < profilerLines.size(); ++i) {
+                        drawCachedText(renderer, smallFont, profilerCache[i], profilerLines[i], 8, 53 + (int)i * 12, profilerColor);
+                    }
+                }
+#endif
 
                 SDL_RenderPresent(renderer);
 
@@ -1335,6 +1319,8 @@ int main(int argc, char* argv[]) {
 
         
 
+        PROFILE_END_FRAME();
+
         Uint32 frameTime = SDL_GetTicks() - frameStart;
         if (frameDelay > (int)frameTime) {
             SDL_Delay(frameDelay - frameTime);
@@ -1343,6 +1329,8 @@ int main(int argc, char* argv[]) {
 
     TTF_CloseFont(smallFont);
     TTF_CloseFont(font);
+    simulation.stop();
+    SDL_DestroyTexture(bulletTexture);
     SDL_DestroyTexture(viewportTexture);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
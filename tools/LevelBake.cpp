@@ -0,0 +1,16 @@
+// Bakes a scene image into a level file (see LevelFile.h) that the game memory-maps
+// instead of decoding the image at startup.
+//
+// Usage: level_bake <scene.png> <level.lvl>
+
+#include "LevelFile.h"
+#include <iostream>
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "Usage: level_bake <scene.png> <level.lvl>" << std::endl;
+        return 1;
+    }
+
+    return LevelFile::bake(argv[1], argv[2]) ? 0 : 1;
+}